@@ -181,19 +181,24 @@ bool TAABB<T, d>::Raycast(const TVector<T, d>& StartPoint, const TVector<T, d>&
 template<typename T, int d, class TTRANSFORM>
 inline TAABB<T, d> TransformedAABBHelper(const TAABB<T, d>& AABB, const TTRANSFORM& SpaceTransform)
 {
-	TVector<T, d> CurrentExtents = AABB.Extents();
-	int32 Idx = 0;
+	//the transform is affine, so every corner is the transformed min plus some subset of the transformed edges.
+	//summing the negative and positive parts of the edges gives the same bounds as transforming all 2^d corners
+	const TVector<T, d> CurrentExtents = AABB.Extents();
 	const TVector<T, d> MinToNewSpace = SpaceTransform.TransformPosition(AABB.Min());
-	TAABB<T, d> NewAABB(MinToNewSpace, MinToNewSpace);
-	NewAABB.GrowToInclude(SpaceTransform.TransformPosition(AABB.Max()));
+	TVector<T, d> NewMin = MinToNewSpace;
+	TVector<T, d> NewMax = MinToNewSpace;
 
 	for (int32 j = 0; j < d; ++j)
 	{
-		NewAABB.GrowToInclude(SpaceTransform.TransformPosition(AABB.Min() + TVector<T, d>::AxisVector(j) * CurrentExtents));
-		NewAABB.GrowToInclude(SpaceTransform.TransformPosition(AABB.Max() - TVector<T, d>::AxisVector(j) * CurrentExtents));
+		const TVector<T, d> EdgeInNewSpace = SpaceTransform.TransformPosition(AABB.Min() + TVector<T, d>::AxisVector(j) * CurrentExtents) - MinToNewSpace;
+		for (int32 i = 0; i < d; ++i)
+		{
+			NewMin[i] += FMath::Min(EdgeInNewSpace[i], (T)0);
+			NewMax[i] += FMath::Max(EdgeInNewSpace[i], (T)0);
+		}
 	}
 
-	return NewAABB;
+	return TAABB<T, d>(NewMin, NewMax);
 }
 
 inline TAABB<float, 3> TransformedAABBHelperISPC(const TAABB<float, 3>& AABB, const FTransform& SpaceTransform)
@@ -14,6 +14,12 @@ namespace Chaos
 
 	float MinBoundsThickness = 0.1f;
 	FAutoConsoleVariableRef CVarMinBoundsThickness(TEXT("p.MinBoundsThickness"), MinBoundsThickness, TEXT(""));
+
+	int32 BVHSAHSplit = 1;
+	FAutoConsoleVariableRef CVarBVHSAHSplit(TEXT("p.BVH.SAHSplit"), BVHSAHSplit, TEXT("Whether binary BVH splits place their split plane with a binned surface area heuristic (1) or at the cell midpoint (0)"));
+
+	int32 BVHSAHNumBins = 16;
+	FAutoConsoleVariableRef CVarBVHSAHNumBins(TEXT("p.BVH.SAHNumBins"), BVHSAHNumBins, TEXT("Number of candidate bins evaluated along the split axis when p.BVH.SAHSplit is enabled [2-64]"));
 }
 
 template<class OBJECT_ARRAY, class LEAF_TYPE, class T, int d>
@@ -182,7 +188,7 @@ void TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::UpdateHierarchyImp
 }
 
 template<class OBJECT_ARRAY, typename TPayloadType, class T, int d>
-TArray<int32> FindAllIntersectionsLeafHelper(const TArray<int32>& Leaf, const TVector<T, d>& Point)
+const TArray<int32>& FindAllIntersectionsLeafHelper(const TArray<int32>& Leaf, const TVector<T, d>& Point)
 {
 	return Leaf;
 }
@@ -214,7 +220,8 @@ TArray<int32> TBoundingVolumeHierarchy<OBJECT_ARRAY, TPayloadType, T, d>::FindAl
 	int32 Child = 0;
 	if (MyNode.MAxis >= 0)
 	{
-		if (Point[MyNode.MAxis] > ObjectCenter[MyNode.MAxis])
+		//binary splits are not necessarily at the center, the first child's max is the split plane
+		if (Point[MyNode.MAxis] > Elements[MyNode.MChildren[0]].MMax[MyNode.MAxis])
 			Child += 1;
 	}
 	else
@@ -238,14 +245,38 @@ bool IntersectsHelper(const TAABB<T, d>& WorldSpaceBox, const TAABB<T, d>& Local
 template <typename T, int d>
 bool IntersectsHelper(const TAABB<T, d>& WorldSpaceBox, const TSpatialRay<T, d>& Ray)
 {
-	//Very slow, should look at using slab algorithm
-	const FBox VolumeBox(WorldSpaceBox.Min(), WorldSpaceBox.Max());
-	FVector Hit;
-	FVector Normal;
-	float Time;
-	return FMath::LineExtentBoxIntersection(VolumeBox, Ray.Start, Ray.End, FVector::ZeroVector, Hit, Normal, Time);
+	//slab test against the segment, a ray starting inside the box counts as intersecting
+	const TVector<T, d>& Min = WorldSpaceBox.Min();
+	const TVector<T, d>& Max = WorldSpaceBox.Max();
+	const TVector<T, d> Dir = Ray.End - Ray.Start;
+	T EntryTime = 0;
+	T ExitTime = 1;
+	for (int32 Axis = 0; Axis < d; ++Axis)
+	{
+		if (FMath::Abs(Dir[Axis]) < SMALL_NUMBER)
+		{
+			if (Ray.Start[Axis] < Min[Axis] || Ray.Start[Axis] > Max[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
 
-	//return WorldSpaceBox.FindClosestIntersection(Ray.Start, Ray.End, 0).Second;
+		const T InvDir = 1 / Dir[Axis];
+		T Time0 = (Min[Axis] - Ray.Start[Axis]) * InvDir;
+		T Time1 = (Max[Axis] - Ray.Start[Axis]) * InvDir;
+		if (Time0 > Time1)
+		{
+			Swap(Time0, Time1);
+		}
+		EntryTime = FMath::Max(EntryTime, Time0);
+		ExitTime = FMath::Min(ExitTime, Time1);
+		if (EntryTime > ExitTime)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 template <typename OBJECT_ARRAY>
@@ -291,7 +322,7 @@ struct TSpecializeParticlesHelper<TParticles<T,d>>
 };
 
 template<class OBJECT_ARRAY, typename TPayloadType, typename T, int d, typename QUERY_OBJECT>
-TArray<int32> FindAllIntersectionsLeafHelper(const TArray<int32>& Leaf, const QUERY_OBJECT& QueryObject)
+const TArray<int32>& FindAllIntersectionsLeafHelper(const TArray<int32>& Leaf, const QUERY_OBJECT& QueryObject)
 {
 	return Leaf;
 }
@@ -313,22 +344,51 @@ template<class OBJECT_ARRAY, class LEAF_TYPE, class T, int d>
 template <typename QUERY_OBJECT>
 void TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::FindAllIntersectionsHelperRecursive(const TBVHNode<T,d>& MyNode, const QUERY_OBJECT& QueryObject, TArray<int32>& AccumulateElements) const
 {
-	TAABB<T, d> MBox(MyNode.MMin, MyNode.MMax);
-	if (!IntersectsHelper(MBox, QueryObject))
+	//iterate with an inline stack so small queries don't recurse or touch the heap
+	TArray<const TBVHNode<T, d>*, TInlineAllocator<64>> NodeStack;
+	NodeStack.Add(&MyNode);
+	while (NodeStack.Num())
 	{
-		return;
+		const TBVHNode<T, d>& Node = *NodeStack.Pop(false);
+		TAABB<T, d> MBox(Node.MMin, Node.MMax);
+		if (!IntersectsHelper(MBox, QueryObject))
+		{
+			continue;
+		}
+		if (Node.MChildren.Num() == 0)
+		{
+			TSpecializeParticlesHelper<OBJECT_ARRAY>::AccumulateChildrenResults(AccumulateElements, FindAllIntersectionsLeafHelper<OBJECT_ARRAY, TPayloadType, T, d>(Leafs[Node.LeafIndex], QueryObject), QueryObject, MWorldSpaceBoxes);
+			continue;
+		}
+
+		//push in reverse so children are visited in the same order as the recursive traversal
+		for (int32 Child = Node.MChildren.Num() - 1; Child >= 0; --Child)
+		{
+			NodeStack.Add(&Elements[Node.MChildren[Child]]);
+		}
 	}
-	if (MyNode.MChildren.Num() == 0)
+}
+
+// Sort and remove duplicates in place, objects spanning several cells are reported once per cell
+inline void SortAndRemoveDuplicateIntersections(TArray<int32>& IntersectionList)
+{
+	const int32 NumIntersections = IntersectionList.Num();
+	if (NumIntersections < 2)
 	{
-		TSpecializeParticlesHelper<OBJECT_ARRAY>::AccumulateChildrenResults(AccumulateElements, FindAllIntersectionsLeafHelper<OBJECT_ARRAY, TPayloadType, T, d>(Leafs[MyNode.LeafIndex], QueryObject), QueryObject, MWorldSpaceBoxes);
 		return;
 	}
-	
-	int32 NumChildren = MyNode.MChildren.Num();
-	for (int32 Child = 0; Child < NumChildren; ++Child)
+
+	IntersectionList.Sort();
+
+	int32 NumUnique = 1;
+	for (int32 i = 1; i < NumIntersections; ++i)
 	{
-		FindAllIntersectionsHelperRecursive(Elements[MyNode.MChildren[Child]], QueryObject, AccumulateElements);
+		if (IntersectionList[i] != IntersectionList[NumUnique - 1])
+		{
+			IntersectionList[NumUnique++] = IntersectionList[i];
+		}
 	}
+	IntersectionList.SetNum(NumUnique, false);
 }
 
 int32 UseAccumulationArray = 1;
@@ -340,15 +400,7 @@ TArray<int32> TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::FindAllIn
 	TArray<int32> IntersectionList;
 	FindAllIntersectionsHelperRecursive(MyNode, ObjectBox, IntersectionList);
 
-	IntersectionList.Sort();
-
-	for (int32 i = IntersectionList.Num() - 1; i > 0; i--)
-	{
-		if (IntersectionList[i] == IntersectionList[i - 1])
-		{
-			IntersectionList.RemoveAtSwap(i, 1, false);
-		}
-	}
+	SortAndRemoveDuplicateIntersections(IntersectionList);
 
 	return IntersectionList;
 }
@@ -359,15 +411,7 @@ TArray<int32> TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::FindAllIn
 	TArray<int32> IntersectionList;
 	FindAllIntersectionsHelperRecursive(MyNode, Ray, IntersectionList);
 
-	IntersectionList.Sort();
-
-	for (int32 i = IntersectionList.Num() - 1; i > 0; i--)
-	{
-		if (IntersectionList[i] == IntersectionList[i - 1])
-		{
-			IntersectionList.RemoveAtSwap(i, 1, false);
-		}
-	}
+	SortAndRemoveDuplicateIntersections(IntersectionList);
 
 	return IntersectionList;
 }
@@ -404,6 +448,83 @@ void AccumulateNextLevelCount(const TAABB<T, d>& Box, const TVector<T, d>& MidPo
 		Counts.Pos[i] += (Box.Min()[i] > MidPoint[i] || Box.Max()[i] > MidPoint[i]) ? 1 : 0;
 	}
 }
+
+template <typename T, int d>
+T ComputeCellArea(const TVector<T, d>& Extents)
+{
+	//half surface area, only used for relative comparisons
+	T Area = 0;
+	for (int32 i = 0; i < d; ++i)
+	{
+		for (int32 j = i + 1; j < d; ++j)
+		{
+			Area += Extents[i] * Extents[j];
+		}
+	}
+	return Area;
+}
+
+// Pick the split plane along Axis that minimizes the surface area heuristic of the two child cells.
+// Objects straddling the plane go into both children (see GenerateNextLevel), so the left count is the
+// number of boxes starting before the plane and the right count the number ending after it.
+template <typename T, int d, typename FGetObjectBox>
+T ComputeSAHSplitPosition(const TVector<T, d>& GlobalMin, const TVector<T, d>& GlobalMax, const TArray<int32>& Objects, const int32 Axis, const FGetObjectBox& GetObjectBox)
+{
+	const T Midpoint = (GlobalMin[Axis] + GlobalMax[Axis]) * (T)0.5;
+	const T AxisExtent = GlobalMax[Axis] - GlobalMin[Axis];
+	if (!BVHSAHSplit || !(AxisExtent > SMALL_NUMBER))
+	{
+		return Midpoint;
+	}
+
+	constexpr int32 MaxBins = 64;
+	const int32 NumBins = FMath::Clamp(BVHSAHNumBins, 2, MaxBins);
+	const T BinScale = NumBins / AxisExtent;
+
+	int32 MinCounts[MaxBins] = {};
+	int32 MaxCounts[MaxBins] = {};
+	for (const int32 Object : Objects)
+	{
+		const TAABB<T, d>& ObjectBox = GetObjectBox(Object);
+		const int32 MinBin = FMath::Clamp(FMath::FloorToInt((ObjectBox.Min()[Axis] - GlobalMin[Axis]) * BinScale), 0, NumBins - 1);
+		const int32 MaxBin = FMath::Clamp(FMath::FloorToInt((ObjectBox.Max()[Axis] - GlobalMin[Axis]) * BinScale), 0, NumBins - 1);
+		++MinCounts[MinBin];
+		++MaxCounts[MaxBin];
+	}
+
+	//suffix sums of the max counts give the number of objects reaching past each bin boundary
+	int32 NumRight[MaxBins + 1];
+	NumRight[NumBins] = 0;
+	for (int32 Bin = NumBins - 1; Bin >= 0; --Bin)
+	{
+		NumRight[Bin] = NumRight[Bin + 1] + MaxCounts[Bin];
+	}
+
+	T BestCost = TNumericLimits<T>::Max();
+	T BestSplit = Midpoint;
+	int32 NumLeft = 0;
+	TVector<T, d> CellExtents = GlobalMax - GlobalMin;
+	for (int32 Boundary = 1; Boundary < NumBins; ++Boundary)
+	{
+		NumLeft += MinCounts[Boundary - 1];
+		const T Split = GlobalMin[Axis] + Boundary / BinScale;
+
+		CellExtents[Axis] = Split - GlobalMin[Axis];
+		const T LeftArea = ComputeCellArea(CellExtents);
+		CellExtents[Axis] = GlobalMax[Axis] - Split;
+		const T RightArea = ComputeCellArea(CellExtents);
+
+		const T Cost = LeftArea * NumLeft + RightArea * NumRight[Boundary];
+		if (Cost < BestCost)
+		{
+			BestCost = Cost;
+			BestSplit = Split;
+		}
+	}
+
+	return BestSplit;
+}
+
 template<class OBJECT_ARRAY, class LEAF_TYPE, class T, int d>
 int32 TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::GenerateNextLevel(const TVector<T, d>& GlobalMin, const TVector<T, d>& GlobalMax, const TArray<int32>& Objects, const int32 Axis, const int32 Level, const bool AllowMultipleSplitting)
 {
@@ -420,9 +541,16 @@ int32 TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::GenerateNextLevel
 	LocalObjects.SetNum(2);
 	LocalLeafs.SetNum(2);
 	TAABB<T, d> GlobalBox(GlobalMin, GlobalMax);
-	const TVector<T, d> WorldCenter = GlobalBox.Center();
-	const TVector<T, d> MinCenterSearch = TAABB<T, d>(GlobalMin, WorldCenter).Center();
-	const TVector<T, d> MaxCenterSearch = TAABB<T, d>(WorldCenter, GlobalMax).Center();
+	const T SplitPosition = ComputeSAHSplitPosition(GlobalMin, GlobalMax, Objects, Axis, [this](const int32 Object) -> const TAABB<T, d>&
+	{
+		return Chaos::GetWorldSpaceBoundingBox(*MObjects, Object, MWorldSpaceBoxes);
+	});
+	TVector<T, d> SplitMax = GlobalMax;
+	TVector<T, d> SplitMin = GlobalMin;
+	SplitMax[Axis] = SplitPosition;
+	SplitMin[Axis] = SplitPosition;
+	const TVector<T, d> MinCenterSearch = TAABB<T, d>(GlobalMin, SplitMax).Center();
+	const TVector<T, d> MaxCenterSearch = TAABB<T, d>(SplitMin, GlobalMax).Center();
 
 	for (int32 i = 0; i < Objects.Num(); ++i)
 	{
@@ -430,11 +558,11 @@ int32 TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::GenerateNextLevel
 		const TAABB<T, d>& ObjectBox = Chaos::GetWorldSpaceBoundingBox(*MObjects, Objects[i], MWorldSpaceBoxes);
 		const TVector<T, d> ObjectCenter = ObjectBox.Center();
 		bool MinA = false, MaxA = false;
-		if (ObjectBox.Min()[Axis] < WorldCenter[Axis])
+		if (ObjectBox.Min()[Axis] < SplitPosition)
 		{
 			MinA = true;
 		}
-		if (ObjectBox.Max()[Axis] >= WorldCenter[Axis])
+		if (ObjectBox.Max()[Axis] >= SplitPosition)
 		{
 			MaxA = true;
 		}
@@ -454,9 +582,9 @@ int32 TBoundingVolumeHierarchy<OBJECT_ARRAY, LEAF_TYPE, T, d>::GenerateNextLevel
 		TVector<T, d> Min = GlobalBox.Min();
 		TVector<T, d> Max = GlobalBox.Max();
 		if (i == 0)
-			Max[Axis] = WorldCenter[Axis];
+			Max[Axis] = SplitPosition;
 		else
-			Min[Axis] = WorldCenter[Axis];
+			Min[Axis] = SplitPosition;
 		LocalElements[i].MMin = Min;
 		LocalElements[i].MMax = Max;
 		LocalElements[i].MAxis = -1;
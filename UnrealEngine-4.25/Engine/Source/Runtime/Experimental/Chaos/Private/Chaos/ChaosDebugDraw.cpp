@@ -13,6 +13,8 @@
 #include "Chaos/PBDRigidParticles.h"
 #include "Chaos/Sphere.h"
 #include "Chaos/Utilities.h"
+#include "ChaosLog.h"
+#include "HAL/ThreadSafeCounter.h"
 
 //#pragma optimize ("", off)
 
@@ -35,6 +37,7 @@ namespace Chaos
 		float ShapeThicknesScale = 1.0f;
 		float PointSize = 2.0f;
 		int DrawPriority = 10.0f;
+		int32 MaxElementsPerDraw = 0;
 
 		FAutoConsoleVariableRef CVarArrowSize(TEXT("p.Chaos.DebugDrawArrowSize"), ArrowSize, TEXT("ArrowSize."));
 		FAutoConsoleVariableRef CVarBodyAxisLen(TEXT("p.Chaos.DebugDrawBodyAxisLen"), BodyAxisLen, TEXT("BodyAxisLen."));
@@ -46,6 +49,52 @@ namespace Chaos
 		FAutoConsoleVariableRef CVarLineThickness(TEXT("p.Chaos.DebugDrawLineThickness"), LineThickness, TEXT("LineThickness."));
 		FAutoConsoleVariableRef CVarLineShapeThickness(TEXT("p.Chaos.DebugDrawShapeLineThicknessScale"), ShapeThicknesScale, TEXT("Shape lineThickness multiplier."));
 		FAutoConsoleVariableRef CVarScale(TEXT("p.Chaos.DebugDrawScale"), DrawScale, TEXT("Scale applied to all Chaos Debug Draw line lengths etc."));
+		FAutoConsoleVariableRef CVarMaxElementsPerDraw(TEXT("p.Chaos.DebugDrawMaxElements"), MaxElementsPerDraw, TEXT("Maximum number of particles or constraints each debug draw call queues. Elements beyond the budget are dropped and counted. 0 means no limit."));
+
+#if CHAOS_DEBUG_DRAW
+		// Total number of elements dropped because a draw call hit p.Chaos.DebugDrawMaxElements
+		FThreadSafeCounter NumDroppedElements;
+
+		/**
+		 * Per draw call element budget.  Every queued element contends on the debug draw
+		 * queue, so heavy scenes can cap how much each call pushes.
+		 */
+		class FDrawBudget
+		{
+		public:
+			FDrawBudget()
+				: MaxElements(MaxElementsPerDraw)
+				, NumDrawn(0)
+				, NumDropped(0)
+			{
+			}
+
+			~FDrawBudget()
+			{
+				if (NumDropped > 0)
+				{
+					const int32 TotalDropped = NumDroppedElements.Add(NumDropped) + NumDropped;
+					UE_LOG(LogChaos, Verbose, TEXT("Debug draw dropped %d elements over budget (%d total)"), NumDropped, TotalDropped);
+				}
+			}
+
+			bool TryDraw()
+			{
+				if (MaxElements > 0 && NumDrawn >= MaxElements)
+				{
+					++NumDropped;
+					return false;
+				}
+				++NumDrawn;
+				return true;
+			}
+
+		private:
+			const int32 MaxElements;
+			int32 NumDrawn;
+			int32 NumDropped;
+		};
+#endif
 
 		//
 		//
@@ -337,9 +386,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -350,9 +403,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -363,9 +420,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleShapesImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -376,9 +437,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -389,9 +454,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -402,9 +471,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					if (Budget.TryDraw())
+					{
+						DrawParticleBoundsImpl(SpaceTransform, GetHandleHelper(&Particle), Color);
+					}
 				}
 			}
 #endif
@@ -415,10 +488,14 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				int32 Index = 0;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					if (Budget.TryDraw())
+					{
+						DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					}
 				}
 			}
 #endif
@@ -429,10 +506,14 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				int32 Index = 0;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					if (Budget.TryDraw())
+					{
+						DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					}
 				}
 			}
 #endif
@@ -443,10 +524,14 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				int32 Index = 0;
 				for (auto& Particle : ParticlesView)
 				{
-					DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					if (Budget.TryDraw())
+					{
+						DrawParticleTransformImpl(SpaceTransform, GetHandleHelper(&Particle), Index++, 1.0f);
+					}
 				}
 			}
 #endif
@@ -457,12 +542,16 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (const Chaos::TPBDCollisionConstraintHandle<float, 3> * ConstraintHandle : Collisions.GetConstConstraintHandles())
 				{
 					TVector<const TGeometryParticleHandle<float, 3>*, 2> ConstrainedParticles = ConstraintHandle->GetConstrainedParticles();
 					if ((ConstrainedParticles[0] == Particle) || (ConstrainedParticles[1] == Particle))
 					{
-						DrawCollisionImpl(SpaceTransform, ConstraintHandle, 1.0f);
+						if (Budget.TryDraw())
+						{
+							DrawCollisionImpl(SpaceTransform, ConstraintHandle, 1.0f);
+						}
 					}
 				}
 			}
@@ -474,9 +563,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (int32 ConstraintIndex = 0; ConstraintIndex < Collisions.NumConstraints(); ++ConstraintIndex)
 				{
-					DrawCollisionImpl(SpaceTransform, Collisions.GetConstraint(ConstraintIndex), ColorScale);
+					if (Budget.TryDraw())
+					{
+						DrawCollisionImpl(SpaceTransform, Collisions.GetConstraint(ConstraintIndex), ColorScale);
+					}
 				}
 			}
 #endif
@@ -487,9 +580,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (const TPBDCollisionConstraintHandle<float, 3>* ConstraintHandle : ConstraintHandles)
 				{
-					DrawCollisionImpl(SpaceTransform, ConstraintHandle, ColorScale);
+					if (Budget.TryDraw())
+					{
+						DrawCollisionImpl(SpaceTransform, ConstraintHandle, ColorScale);
+					}
 				}
 			}
 #endif
@@ -501,9 +598,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (const FPBDJointConstraintHandle* ConstraintHandle : ConstraintHandles)
 				{
-					DrawJointConstraintImpl(SpaceTransform, ConstraintHandle, ColorScale, FeatureMask);
+					if (Budget.TryDraw())
+					{
+						DrawJointConstraintImpl(SpaceTransform, ConstraintHandle, ColorScale, FeatureMask);
+					}
 				}
 			}
 #endif
@@ -514,9 +615,13 @@ namespace Chaos
 #if CHAOS_DEBUG_DRAW
 			if (FDebugDrawQueue::IsDebugDrawingEnabled())
 			{
+				FDrawBudget Budget;
 				for (int32 ConstraintIndex = 0; ConstraintIndex < Constraints.NumConstraints(); ++ConstraintIndex)
 				{
-					DrawJointConstraintImpl(SpaceTransform, Constraints.GetConstraintHandle(ConstraintIndex), ColorScale, FeatureMask);
+					if (Budget.TryDraw())
+					{
+						DrawJointConstraintImpl(SpaceTransform, Constraints.GetConstraintHandle(ConstraintIndex), ColorScale, FeatureMask);
+					}
 				}
 			}
 #endif
@@ -1,8 +1,309 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Chaos/ChaosPerfTest.h"
+#include "Chaos/Box.h"
+#include "Chaos/PBDRigidsEvolutionGBF.h"
+#include "Chaos/PBDRigidsEvolutionRollback.h"
+#include "Chaos/SegmentMesh.h"
+#include "Chaos/TriangleMesh.h"
+#include "ChaosLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
 
 #if CHAOS_PERF_TEST_ENABLED
 const TCHAR* FChaosScopedDurationTimeLogger::GlobalLabel = nullptr;
 EChaosPerfUnits FChaosScopedDurationTimeLogger::GlobalUnits = EChaosPerfUnits::S;
 #endif
+
+#if !UE_BUILD_SHIPPING
+namespace Chaos
+{
+namespace
+{
+	/**
+	 * Build a reproducible GridSize x GridSize vertex sheet with two triangles per quad and
+	 * a little height noise, so curvature and coincident vertex passes have work to do.
+	 */
+	static void BuildTriangleMeshSheet(const int32 GridSize, TArray<TVector<float, 3>>& OutPoints, TArray<TVector<int32, 3>>& OutElements)
+	{
+		FRandomStream Rand(GridSize);
+		OutPoints.Reset(GridSize * GridSize);
+		for (int32 Y = 0; Y < GridSize; ++Y)
+		{
+			for (int32 X = 0; X < GridSize; ++X)
+			{
+				OutPoints.Add(TVector<float, 3>((float)X, (float)Y, Rand.FRandRange(-0.25f, 0.25f)));
+			}
+		}
+
+		OutElements.Reset(2 * (GridSize - 1) * (GridSize - 1));
+		for (int32 Y = 0; Y < GridSize - 1; ++Y)
+		{
+			for (int32 X = 0; X < GridSize - 1; ++X)
+			{
+				const int32 V00 = Y * GridSize + X;
+				const int32 V10 = V00 + 1;
+				const int32 V01 = V00 + GridSize;
+				const int32 V11 = V01 + 1;
+				OutElements.Add(TVector<int32, 3>(V00, V10, V11));
+				OutElements.Add(TVector<int32, 3>(V00, V11, V01));
+			}
+		}
+	}
+
+	/** Time each named TTriangleMesh connectivity pass on a freshly built mesh, averaged over NumIterations. */
+	static void RunTriangleMeshPerfTest(const TArray<FString>& Args)
+	{
+		const int32 GridSize = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 128, 2);
+		const int32 NumIterations = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4, 1);
+
+		TArray<TVector<float, 3>> Points;
+		TArray<TVector<int32, 3>> Elements;
+		BuildTriangleMeshSheet(GridSize, Points, Elements);
+		const TArrayView<const TVector<float, 3>> PointsView(Points);
+
+		double SegmentMeshTime = 0.;
+		double NeighborsTime = 0.;
+		double AdjacentElementsTime = 0.;
+		double ImportanceOrderingTime = 0.;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			TArray<TVector<int32, 3>> MeshElements = Elements;
+			TTriangleMesh<float> Mesh(MoveTemp(MeshElements));
+
+			double StartTime = FPlatformTime::Seconds();
+			Mesh.GetSegmentMesh();
+			SegmentMeshTime += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			Mesh.GetPointToNeighborsMap();
+			NeighborsTime += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			Mesh.GetUniqueAdjacentElements();
+			AdjacentElementsTime += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			Mesh.GetVertexImportanceOrdering(PointsView, nullptr, false);
+			ImportanceOrderingTime += FPlatformTime::Seconds() - StartTime;
+		}
+
+		const double ToMs = 1000. / NumIterations;
+		UE_LOG(LogChaos, Display, TEXT("TriangleMesh perf test: %d vertices, %d triangles, %d iterations"), Points.Num(), Elements.Num(), NumIterations);
+		UE_LOG(LogChaos, Display, TEXT("  GetSegmentMesh:              %.3f ms"), SegmentMeshTime * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  GetPointToNeighborsMap:      %.3f ms"), NeighborsTime * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  GetUniqueAdjacentElements:   %.3f ms"), AdjacentElementsTime * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  GetVertexImportanceOrdering: %.3f ms"), ImportanceOrderingTime * ToMs);
+	}
+
+	FAutoConsoleCommand CommandTriangleMeshPerfTest(
+		TEXT("p.Chaos.PerfTest.TriangleMesh"),
+		TEXT("Time TTriangleMesh connectivity passes on a generated sheet. Args: [GridSize=128] [Iterations=4]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunTriangleMeshPerfTest));
+
+	/**
+	 * A rigid evolution holding Columns x Columns stacks of NumLevels unit boxes on a static ground box. The scene owns the
+	 * geometry and materials, and is laid out the same way every time so runs can be compared across builds.
+	 */
+	struct FBoxStackScene
+	{
+		static constexpr FReal BoxSize = 100;
+		static constexpr FReal BoxGap = 1;
+
+		TUniquePtr<FImplicitObject> GroundGeometry;
+		TUniquePtr<FImplicitObject> BoxGeometry;
+		TUniquePtr<FChaosPhysicsMaterial> Material;
+		TPBDRigidsSOAs<FReal, 3> Particles;
+		FPBDRigidsEvolutionGBF Evolution;
+		TArray<TPBDRigidParticleHandle<FReal, 3>*> Boxes;
+
+		FBoxStackScene(const int32 Columns, const int32 NumLevels, const bool bSingleThreaded)
+			: GroundGeometry(new TBox<FReal, 3>(FVec3(-10000, -10000, -100), FVec3(10000, 10000, 0)))
+			, BoxGeometry(new TBox<FReal, 3>(FVec3(-BoxSize / 2), FVec3(BoxSize / 2)))
+			, Material(MakeUnique<FChaosPhysicsMaterial>())
+			, Evolution(Particles, FPBDRigidsEvolutionGBF::DefaultNumIterations, FPBDRigidsEvolutionGBF::DefaultNumPushOutIterations, bSingleThreaded)
+		{
+			TGeometryParticleHandle<FReal, 3>* Ground = Evolution.CreateStaticParticles(1)[0];
+			InitParticle(*Ground, GroundGeometry, FVec3(0));
+
+			const FReal Mass = 1;
+			const FReal Inertia = Mass * BoxSize * BoxSize / 6;
+			Boxes = Evolution.CreateDynamicParticles(Columns * Columns * NumLevels);
+			for (int32 Index = 0; Index < Boxes.Num(); ++Index)
+			{
+				const int32 Level = Index % NumLevels;
+				const int32 Column = Index / NumLevels;
+				const FVec3 Location((Column % Columns) * 4 * BoxSize, (Column / Columns) * 4 * BoxSize, (Level + (FReal)0.5) * (BoxSize + BoxGap));
+
+				TPBDRigidParticleHandle<FReal, 3>* Box = Boxes[Index];
+				InitParticle(*Box, BoxGeometry, Location);
+				Box->P() = Box->X();
+				Box->Q() = Box->R();
+				Box->V() = FVec3(0);
+				Box->W() = FVec3(0);
+				Box->M() = Mass;
+				Box->InvM() = 1 / Mass;
+				Box->I() = PMatrix<FReal, 3, 3>(Inertia, Inertia, Inertia);
+				Box->InvI() = PMatrix<FReal, 3, 3>(1 / Inertia, 1 / Inertia, 1 / Inertia);
+			}
+		}
+
+		void InitParticle(TGeometryParticleHandle<FReal, 3>& Particle, const TUniquePtr<FImplicitObject>& Geometry, const FVec3& Location)
+		{
+			Particle.X() = Location;
+			Particle.R() = FRotation3::Identity;
+			Particle.SetGeometry(MakeSerializable(Geometry));
+			Particle.SetHasBounds(true);
+			Particle.SetLocalBounds(Geometry->BoundingBox());
+			Particle.SetWorldSpaceInflatedBounds(Geometry->BoundingBox().TransformedAABB(TRigidTransform<FReal, 3>(Particle.X(), Particle.R())));
+			for (const TUniquePtr<TPerShapeData<FReal, 3>>& Shape : Particle.ShapesArray())
+			{
+				// Collide with everything on the default channel
+				Shape->SimData.Word1 = 1;
+				Shape->SimData.Word3 = 1;
+			}
+			Evolution.SetPhysicsMaterial(&Particle, MakeSerializable(Material));
+			Evolution.DirtyParticle(Particle);
+		}
+	};
+
+	/**
+	 * Step a box stack scene and report where the time goes. The stages are split at the evolution's callbacks so they line
+	 * up with the STAT_Evolution_* counters, which are also live while the command runs (stat Chaos).
+	 */
+	static void RunBoxStackPerfTest(const TArray<FString>& Args)
+	{
+		const int32 Columns = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4, 1);
+		const int32 NumLevels = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10, 1);
+		const int32 NumSteps = FMath::Max(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 120, 1);
+		const bool bSingleThreaded = Args.Num() > 3 && FCString::Atoi(*Args[3]) != 0;
+		const FReal Dt = (FReal)1 / 60;
+
+		FBoxStackScene Scene(Columns, NumLevels, bSingleThreaded);
+
+		uint64 PostIntegrateCycles = 0;
+		uint64 PostDetectCollisionsCycles = 0;
+		uint64 PreApplyCycles = 0;
+		Scene.Evolution.SetPostIntegrateCallback([&PostIntegrateCycles]() { PostIntegrateCycles = FPlatformTime::Cycles64(); });
+		Scene.Evolution.SetPostDetectCollisionsCallback([&PostDetectCollisionsCycles]() { PostDetectCollisionsCycles = FPlatformTime::Cycles64(); });
+		Scene.Evolution.SetPreApplyCallback([&PreApplyCycles]() { PreApplyCycles = FPlatformTime::Cycles64(); });
+
+		uint64 IntegrateCycles = 0;
+		uint64 DetectCollisionsCycles = 0;
+		uint64 IslandsCycles = 0;
+		uint64 SolveCycles = 0;
+		uint64 MaxStepCycles = 0;
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Scene.Evolution.AdvanceOneTimeStep(Dt);
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+
+			IntegrateCycles += PostIntegrateCycles - StartCycles;
+			DetectCollisionsCycles += PostDetectCollisionsCycles - PostIntegrateCycles;
+			IslandsCycles += PreApplyCycles - PostDetectCollisionsCycles;
+			SolveCycles += EndCycles - PreApplyCycles;
+			MaxStepCycles = FMath::Max(MaxStepCycles, EndCycles - StartCycles);
+		}
+
+		const double ToMs = FPlatformTime::GetSecondsPerCycle64() * 1000. / NumSteps;
+		int32 NumAwake = 0;
+		for (const TPBDRigidParticleHandle<FReal, 3>* Box : Scene.Boxes)
+		{
+			NumAwake += Box->ObjectState() == EObjectStateType::Dynamic ? 1 : 0;
+		}
+		UE_LOG(LogChaos, Display, TEXT("BoxStack perf test: %d boxes in %d stacks, %d steps%s, %d boxes awake at the end"), Scene.Boxes.Num(), Columns * Columns, NumSteps, bSingleThreaded ? TEXT(" single threaded") : TEXT(""), NumAwake);
+		UE_LOG(LogChaos, Display, TEXT("  Integrate, KinematicTargets:                            %.3f ms"), IntegrateCycles * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  UpdateConstraintPositionBasedState, DetectCollisions:   %.3f ms"), DetectCollisionsCycles * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  PrepareConstraints, CreateConstraintGraph, CreateIslands: %.3f ms"), IslandsCycles * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  ParallelSolve, UnprepareConstraints, DeactivateSleep:   %.3f ms"), SolveCycles * ToMs);
+		UE_LOG(LogChaos, Display, TEXT("  Step average %.3f ms, worst %.3f ms"), (IntegrateCycles + DetectCollisionsCycles + IslandsCycles + SolveCycles) * ToMs, MaxStepCycles * FPlatformTime::GetSecondsPerCycle64() * 1000.);
+	}
+
+	FAutoConsoleCommand CommandBoxStackPerfTest(
+		TEXT("p.Chaos.PerfTest.BoxStack"),
+		TEXT("Step a rigid box stack scene and log per stage timings. Args: [Columns=4] [Levels=10] [Steps=120] [SingleThreaded=0]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBoxStackPerfTest));
+
+	/**
+	 * Time rollback capture, delta encoding and restore on a box stack scene, then resimulate from the restored state and
+	 * log how far the boxes end up from where the original run put them.
+	 */
+	static void RunRollbackPerfTest(const TArray<FString>& Args)
+	{
+		const int32 Columns = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4, 1);
+		const int32 NumLevels = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10, 1);
+		const int32 NumResimSteps = FMath::Max(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 8, 1);
+		const int32 NumSettleSteps = 30;
+		const FReal Dt = (FReal)1 / 60;
+
+		FBoxStackScene Scene(Columns, NumLevels, false);
+		for (int32 Step = 0; Step < NumSettleSteps; ++Step)
+		{
+			Scene.Evolution.AdvanceOneTimeStep(Dt);
+		}
+
+		TArray<uint8> BaseState;
+		CaptureEvolutionRollbackState(Scene.Evolution, BaseState);
+		Scene.Evolution.AdvanceOneTimeStep(Dt);
+
+		TArray<uint8> State;
+		double StartTime = FPlatformTime::Seconds();
+		CaptureEvolutionRollbackState(Scene.Evolution, State);
+		const double CaptureTime = FPlatformTime::Seconds() - StartTime;
+
+		TArray<uint8> Delta;
+		StartTime = FPlatformTime::Seconds();
+		EncodeEvolutionRollbackDelta(BaseState, State, Delta);
+		const double EncodeTime = FPlatformTime::Seconds() - StartTime;
+
+		for (int32 Step = 0; Step < NumResimSteps; ++Step)
+		{
+			Scene.Evolution.AdvanceOneTimeStep(Dt);
+		}
+		TArray<FVec3> OriginalPositions;
+		for (const TPBDRigidParticleHandle<FReal, 3>* Box : Scene.Boxes)
+		{
+			OriginalPositions.Add(Box->X());
+		}
+
+		TArray<uint8> DecodedState;
+		StartTime = FPlatformTime::Seconds();
+		const bool bDecoded = DecodeEvolutionRollbackDelta(BaseState, Delta, DecodedState);
+		const double DecodeTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		const bool bRestored = bDecoded && RestoreEvolutionRollbackState(Scene.Evolution, DecodedState);
+		const double RestoreTime = FPlatformTime::Seconds() - StartTime;
+		if (!bRestored)
+		{
+			UE_LOG(LogChaos, Warning, TEXT("Rollback perf test: restoring the captured state failed"));
+			return;
+		}
+
+		for (int32 Step = 0; Step < NumResimSteps; ++Step)
+		{
+			Scene.Evolution.AdvanceOneTimeStep(Dt);
+		}
+		FReal MaxDeviation = 0;
+		for (int32 Index = 0; Index < Scene.Boxes.Num(); ++Index)
+		{
+			MaxDeviation = FMath::Max(MaxDeviation, (Scene.Boxes[Index]->X() - OriginalPositions[Index]).Size());
+		}
+
+		UE_LOG(LogChaos, Display, TEXT("Rollback perf test: %d boxes, %d resimulated steps"), Scene.Boxes.Num(), NumResimSteps);
+		UE_LOG(LogChaos, Display, TEXT("  Capture: %.3f ms, %d bytes"), CaptureTime * 1000., State.Num());
+		UE_LOG(LogChaos, Display, TEXT("  Encode:  %.3f ms, %d bytes delta"), EncodeTime * 1000., Delta.Num());
+		UE_LOG(LogChaos, Display, TEXT("  Decode:  %.3f ms"), DecodeTime * 1000.);
+		UE_LOG(LogChaos, Display, TEXT("  Restore: %.3f ms"), RestoreTime * 1000.);
+		UE_LOG(LogChaos, Display, TEXT("  Largest resimulation deviation: %g"), MaxDeviation);
+	}
+
+	FAutoConsoleCommand CommandRollbackPerfTest(
+		TEXT("p.Chaos.PerfTest.Rollback"),
+		TEXT("Time rollback capture and restore on a box stack scene and check the resimulation. Args: [Columns=4] [Levels=10] [ResimSteps=8]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunRollbackPerfTest));
+}
+}
+#endif
@@ -22,6 +22,10 @@
 #include "Chaos/TriangleMeshImplicitObject.h"
 #include "Chaos/GeometryQueries.h"
 
+#if INTEL_ISPC
+#include "PBDCollisionConstraints.ispc.generated.h"
+#endif
+
 #if 0
 DECLARE_CYCLE_STAT(TEXT("Collisions::GJK"), STAT_Collisions_GJK, STATGROUP_ChaosCollision);
 #define SCOPE_CYCLE_COUNTER_GJK() SCOPE_CYCLE_COUNTER(STAT_Collisions_GJK)
@@ -60,6 +64,12 @@ float Chaos_Collision_CapsuleBoxManifoldTolerance = FMath::Sin(FMath::DegreesToR
 FConsoleVariableDelegate Chaos_Collision_CapsuleBoxManifoldDelegate = FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* CVar) { Chaos_Collision_CapsuleBoxManifoldTolerance = FMath::Sin(FMath::DegreesToRadians(Chaos_Collision_CapsuleBoxManifoldAngle)); });
 FAutoConsoleVariableRef CVarChaosCollisionBoxCapsuleManifoldAngle(TEXT("p.Chaos.Collision.CapsuleBoxManifoldAngle"), Chaos_Collision_CapsuleBoxManifoldAngle, TEXT("If a capsule is more than this angle from vertical, do not use a manifold"), Chaos_Collision_CapsuleBoxManifoldDelegate);
 
+int32 Chaos_Collision_ConvexSupportISPCMinVertices = 16;
+FAutoConsoleVariableRef CVarChaosCollisionConvexSupportISPCMinVertices(TEXT("p.Chaos.Collision.ConvexSupportISPCMinVertices"), Chaos_Collision_ConvexSupportISPCMinVertices, TEXT("Convex hulls with at least this many vertices use the vectorized support search in GJK. Negative disables it."));
+
+int32 Chaos_Collision_GJKWarmStart = 1;
+FAutoConsoleVariableRef CVarChaosCollisionGJKWarmStart(TEXT("p.Chaos.Collision.GJKWarmStart"), Chaos_Collision_GJKWarmStart, TEXT("Start GJK from the last contact normal of a constraint rather than a fixed axis."));
+
 namespace Chaos
 {
 	namespace Collisions
@@ -188,6 +198,67 @@ namespace Chaos
 		}
 
 
+		// The initial GJK search direction in the space of the first shape. Uses the last contact normal (world space) of
+		// the constraint when there is one, so that pairs that barely moved since the last update converge in a few GJK iterations.
+		template <typename T, int d>
+		TVector<T, d> GetGJKInitialDir(const TRigidTransform<T, d>& ATM, const TVector<T, d>& WarmStartNormal)
+		{
+			if (Chaos_Collision_GJKWarmStart && (WarmStartNormal.SizeSquared() > SMALL_NUMBER))
+			{
+				return ATM.GetRotation().Inverse() * -WarmStartNormal;
+			}
+			return TVector<T, d>(1, 0, 0);
+		}
+
+		// Support function wrapper for FConvex in GJK/EPA. Hulls with many vertices search them with the ConvexSupportVertex
+		// ISPC kernel, everything else uses FConvex::Support.
+		class FConvexGJKSupport
+		{
+		public:
+			FConvexGJKSupport(const FConvex& InConvex)
+				: Convex(InConvex)
+			{
+			}
+
+			FVec3 Support(const FVec3& Direction, const FReal Thickness) const
+			{
+#if INTEL_ISPC
+				const TParticles<FReal, 3>& Vertices = Convex.GetSurfaceParticles();
+				const int32 NumVertices = (int32)Vertices.Size();
+				if ((Chaos_Collision_ConvexSupportISPCMinVertices >= 0) && (NumVertices >= Chaos_Collision_ConvexSupportISPCMinVertices) && (NumVertices > 0))
+				{
+					const int32 VertexIndex = ispc::ConvexSupportVertex((const ispc::FVector*)&Vertices.XArray()[0], (const ispc::FVector&)Direction, NumVertices);
+					if (Thickness)
+					{
+						return Vertices.X(VertexIndex) + Direction.GetUnsafeNormal() * Thickness;
+					}
+					return Vertices.X(VertexIndex);
+				}
+#endif
+				return Convex.Support(Direction, Thickness);
+			}
+
+			const TAABB<FReal, 3>& BoundingBox() const
+			{
+				return Convex.BoundingBox();
+			}
+
+		private:
+			const FConvex& Convex;
+		};
+
+		// Select the shape type used by GJK for a downcast implicit
+		template <typename GeometryType>
+		const GeometryType& MakeGJKShape(const GeometryType& Geometry)
+		{
+			return Geometry;
+		}
+
+		inline FConvexGJKSupport MakeGJKShape(const FConvex& Convex)
+		{
+			return FConvexGJKSupport(Convex);
+		}
+
 		template <typename T, int d, typename GeometryA, typename GeometryB>
 		TContactPoint<T> GJKContactPoint(const GeometryA& A, const TRigidTransform<T, d>& ATM, const GeometryB& B, const TRigidTransform<T, d>& BTM, const TVector<T, 3>& InitialDir)
 		{
@@ -370,13 +441,13 @@ namespace Chaos
 
 
 		template<class T, int d>
-		TContactPoint<T> ConvexConvexContactPoint(const FImplicitObject& A, const TRigidTransform<T, d>& ATM, const FImplicitObject& B, const TRigidTransform<T, d>& BTM, const T CullDistance)
+		TContactPoint<T> ConvexConvexContactPoint(const FImplicitObject& A, const TRigidTransform<T, d>& ATM, const FImplicitObject& B, const TRigidTransform<T, d>& BTM, const T CullDistance, const TVector<T, d>& WarmStartNormal)
 		{
 			TContactPoint<T> ContactPoint = Utilities::CastHelper(A, ATM, [&](const auto& ADowncast, const TRigidTransform<T,d>& AFullTM)
 			{
 				return Utilities::CastHelper(B, BTM, [&](const auto& BDowncast, const TRigidTransform<T,d>& BFullTM)
 				{
-					return GJKContactPoint(ADowncast, AFullTM, BDowncast, BFullTM, TVector<T, d>(1, 0, 0));
+					return GJKContactPoint(MakeGJKShape(ADowncast), AFullTM, MakeGJKShape(BDowncast), BFullTM, GetGJKInitialDir(AFullTM, WarmStartNormal));
 				});
 			});
 
@@ -409,7 +480,7 @@ namespace Chaos
 		void UpdateSingleShotManifold(TRigidBodyMultiPointContactConstraint<T, d>& Constraint, const TRigidTransform<T, d>& Transform0, const TRigidTransform<T, d>& Transform1, const T CullDistance)
 		{
 			// single shot manifolds for TConvex implicit object in the constraints implicit[0] position. 
-			TContactPoint<T> ContactPoint = ConvexConvexContactPoint(*Constraint.Manifold.Implicit[0], Transform0, *Constraint.Manifold.Implicit[1], Transform1, CullDistance);
+			TContactPoint<T> ContactPoint = ConvexConvexContactPoint(*Constraint.Manifold.Implicit[0], Transform0, *Constraint.Manifold.Implicit[1], Transform1, CullDistance, Constraint.Manifold.Normal);
 
 			// Cache the nearest point as the initial contact
 			Constraint.Manifold.Phi = ContactPoint.Phi;
@@ -460,7 +531,7 @@ namespace Chaos
 			};
 
 			// iterative manifolds for non TConvex implicit objects that require sampling 
-			TContactPoint<T> ContactPoint = ConvexConvexContactPoint(*Constraint.Manifold.Implicit[0], Transform0, *Constraint.Manifold.Implicit[1], Transform1, CullDistance);
+			TContactPoint<T> ContactPoint = ConvexConvexContactPoint(*Constraint.Manifold.Implicit[0], Transform0, *Constraint.Manifold.Implicit[1], Transform1, CullDistance, Constraint.Manifold.Normal);
 
 			// Cache the nearest point as the initial contact
 			Constraint.Manifold.Phi = ContactPoint.Phi;
@@ -530,15 +601,15 @@ namespace Chaos
 		// Box - Box
 		//
 		template <typename T, int d>
-		TContactPoint<T> BoxBoxContactPoint(const TAABB<T, d>& Box1, const TRigidTransform<T, d>& ATM, const TAABB<T, d>& Box2, const TRigidTransform<T, d>& BTM, const T CullDistance)
+		TContactPoint<T> BoxBoxContactPoint(const TAABB<T, d>& Box1, const TRigidTransform<T, d>& ATM, const TAABB<T, d>& Box2, const TRigidTransform<T, d>& BTM, const T CullDistance, const TVector<T, d>& WarmStartNormal)
 		{
-			return GJKContactPoint(Box1, ATM, Box2, BTM, TVector<T, d>(1, 0, 0));
+			return GJKContactPoint(Box1, ATM, Box2, BTM, GetGJKInitialDir(ATM, WarmStartNormal));
 		}
 
 		template <typename T, int d>
 		void UpdateBoxBoxConstraint(const TAABB<T, d>& Box1, const TRigidTransform<T, d>& Box1Transform, const TAABB<T, d>& Box2, const TRigidTransform<T, d>& Box2Transform, const T CullDistance, TRigidBodyPointContactConstraint<T, d>& Constraint)
 		{
-			UpdateContactPoint(Constraint.Manifold, BoxBoxContactPoint(Box1, Box1Transform, Box2, Box2Transform, CullDistance));
+			UpdateContactPoint(Constraint.Manifold, BoxBoxContactPoint(Box1, Box1Transform, Box2, Box2Transform, CullDistance, Constraint.Manifold.Normal));
 		}
 
 		template <typename T, int d>
@@ -1541,11 +1612,11 @@ namespace Chaos
 
 			if (ConstraintBase.GetType() == FRigidBodyPointContactConstraint::StaticType())
 			{
-				ContactPoint = ConvexConvexContactPoint(Implicit0, Transform0, Implicit1, Transform1, CullDistance);
+				ContactPoint = ConvexConvexContactPoint(Implicit0, Transform0, Implicit1, Transform1, CullDistance, ConstraintBase.Manifold.Normal);
 			}
 			else if (ConstraintBase.GetType() == FRigidBodySweptPointContactConstraint::StaticType())
 			{
-				ContactPoint = ConvexConvexContactPoint(Implicit0, Transform0, Implicit1, Transform1, CullDistance);
+				ContactPoint = ConvexConvexContactPoint(Implicit0, Transform0, Implicit1, Transform1, CullDistance, ConstraintBase.Manifold.Normal);
 			}
 			else if (ConstraintBase.GetType() == FRigidBodyMultiPointContactConstraint::StaticType())
 			{
@@ -2024,144 +2095,170 @@ namespace Chaos
 			}
 		}
 
-		template<typename T, int d>
-		void ConstructConstraintsImpl(TGeometryParticleHandle<T, d>* Particle0, TGeometryParticleHandle<T, d>* Particle1, const FImplicitObject* Implicit0, const FImplicitObject* Implicit1, const TRigidTransform<T, d>& Transform0, const TRigidTransform<T, d>& Transform1, const T CullDistance, const FCollisionContext& Context, FCollisionConstraintsArray& NewConstraints)
+		// Shape pair handlers for ConstructConstraintsImpl
+		enum class EPairDispatchHandler : uint8
+		{
+			None,
+			BoxBox,
+			BoxHeightField,
+			BoxPlane,
+			BoxTriMesh,
+			SphereSphere,
+			SphereHeightField,
+			SpherePlane,
+			SphereBox,
+			SphereCapsule,
+			SphereTriMesh,
+			CapsuleCapsule,
+			CapsuleBox,
+			CapsuleHeightField,
+			CapsuleTriMesh,
+		};
+
+		struct FPairDispatchEntry
 		{
-			// @todo(chaos): We use GetInnerType here because TriMeshes are left with their "Instanced" wrapper, unlike all other instanced implicits. Should we strip the instance on Tri Mesh too?
-			EImplicitObjectType Implicit0Type = Implicit0 ? GetInnerType(Implicit0->GetCollisionType()) : ImplicitObjectType::Unknown;
-			EImplicitObjectType Implicit1Type = Implicit1 ? GetInnerType(Implicit1->GetCollisionType()) : ImplicitObjectType::Unknown;
-			bool bIsConvex0 = Implicit0 && Implicit0->IsConvex() && Implicit0Type != ImplicitObjectType::LevelSet;
-			bool bIsConvex1 = Implicit1 && Implicit1->IsConvex() && Implicit1Type != ImplicitObjectType::LevelSet;
+			EPairDispatchHandler Handler;
+			bool bSwap;	// The handler expects the shapes in the opposite order
+		};
 
-			T LengthCCD = 0.0f;
-			TVector<T, d> DirCCD(0.0f);
-			bool bUseCCD = UseCCD(Particle0, Particle1, Implicit0, DirCCD, LengthCCD);
+		// Inner implicit types are below the IsScaled/IsInstanced flag bits
+		static const int32 NumPairDispatchTypes = 32;
 
-			if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructBoxBoxConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == THeightField<FReal>::StaticType())
-			{
-				ConstructBoxHeightFieldConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == THeightField<FReal>::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructBoxHeightFieldConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == TPlane<FReal, 3>::StaticType())
-			{
-				ConstructBoxPlaneConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TPlane<FReal, 3>::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructBoxPlaneConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
-			{
-				ConstructSphereSphereConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == THeightField<FReal>::StaticType())
-			{
-				ConstructSphereHeightFieldConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == THeightField<FReal>::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
-			{
-				ConstructSphereHeightFieldConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == TPlane<FReal, 3>::StaticType())
-			{
-				ConstructSpherePlaneConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TPlane<FReal, 3>::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
-			{
-				ConstructSpherePlaneConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructSphereBoxConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
-			{
-				ConstructSphereBoxConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == TCapsule<FReal>::StaticType())
-			{
-				ConstructSphereCapsuleConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TCapsule<FReal>::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
-			{
-				ConstructSphereCapsuleConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TCapsule<FReal>::StaticType() && Implicit1Type == TCapsule<FReal>::StaticType())
-			{
-				ConstructCapsuleCapsuleConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TCapsule<FReal>::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructCapsuleBoxConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, Context, NewConstraints);
-			}
-			else if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == TCapsule<FReal>::StaticType())
+		struct FPairDispatchTable
+		{
+			FPairDispatchEntry Entries[NumPairDispatchTypes][NumPairDispatchTypes];
+
+			FPairDispatchTable()
 			{
-				ConstructCapsuleBoxConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, Context, NewConstraints);
+				FMemory::Memzero(Entries);
+				Add(TBox<FReal, 3>::StaticType(), TBox<FReal, 3>::StaticType(), EPairDispatchHandler::BoxBox);
+				Add(TBox<FReal, 3>::StaticType(), THeightField<FReal>::StaticType(), EPairDispatchHandler::BoxHeightField);
+				Add(TBox<FReal, 3>::StaticType(), TPlane<FReal, 3>::StaticType(), EPairDispatchHandler::BoxPlane);
+				Add(TBox<FReal, 3>::StaticType(), FTriangleMeshImplicitObject::StaticType(), EPairDispatchHandler::BoxTriMesh);
+				Add(TSphere<FReal, 3>::StaticType(), TSphere<FReal, 3>::StaticType(), EPairDispatchHandler::SphereSphere);
+				Add(TSphere<FReal, 3>::StaticType(), THeightField<FReal>::StaticType(), EPairDispatchHandler::SphereHeightField);
+				Add(TSphere<FReal, 3>::StaticType(), TPlane<FReal, 3>::StaticType(), EPairDispatchHandler::SpherePlane);
+				Add(TSphere<FReal, 3>::StaticType(), TBox<FReal, 3>::StaticType(), EPairDispatchHandler::SphereBox);
+				Add(TSphere<FReal, 3>::StaticType(), TCapsule<FReal>::StaticType(), EPairDispatchHandler::SphereCapsule);
+				Add(TSphere<FReal, 3>::StaticType(), FTriangleMeshImplicitObject::StaticType(), EPairDispatchHandler::SphereTriMesh);
+				Add(TCapsule<FReal>::StaticType(), TCapsule<FReal>::StaticType(), EPairDispatchHandler::CapsuleCapsule);
+				Add(TCapsule<FReal>::StaticType(), TBox<FReal, 3>::StaticType(), EPairDispatchHandler::CapsuleBox);
+				Add(TCapsule<FReal>::StaticType(), THeightField<FReal>::StaticType(), EPairDispatchHandler::CapsuleHeightField);
+				Add(TCapsule<FReal>::StaticType(), FTriangleMeshImplicitObject::StaticType(), EPairDispatchHandler::CapsuleTriMesh);
 			}
-			else if (Implicit0Type == TCapsule<FReal>::StaticType() && Implicit1Type == THeightField<FReal>::StaticType())
-			{
-				if (bUseCCD)
-				{
-					ConstructCapsuleHeightFieldConstraintsSwept(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, DirCCD, LengthCCD, NewConstraints);
-					return;
-				}
 
-				ConstructCapsuleHeightFieldConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == THeightField<FReal>::StaticType() && Implicit1Type == TCapsule<FReal>::StaticType())
+			void Add(const EImplicitObjectType Type0, const EImplicitObjectType Type1, const EPairDispatchHandler Handler)
 			{
-				if (bUseCCD)
+				check((Type0 < NumPairDispatchTypes) && (Type1 < NumPairDispatchTypes));
+				Entries[Type0][Type1] = { Handler, false };
+				if (Type0 != Type1)
 				{
-					ConstructCapsuleHeightFieldConstraintsSwept(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, DirCCD, LengthCCD, NewConstraints);
-					return;
+					Entries[Type1][Type0] = { Handler, true };
 				}
-
-				ConstructCapsuleHeightFieldConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == TBox<FReal, 3>::StaticType() && Implicit1Type == FTriangleMeshImplicitObject::StaticType())
-			{
-				ConstructBoxTriangleMeshConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == FTriangleMeshImplicitObject::StaticType() && Implicit1Type == TBox<FReal, 3>::StaticType())
-			{
-				ConstructBoxTriangleMeshConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
 			}
-			else if (Implicit0Type == TSphere<FReal, 3>::StaticType() && Implicit1Type == FTriangleMeshImplicitObject::StaticType())
-			{
-				ConstructSphereTriangleMeshConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == FTriangleMeshImplicitObject::StaticType() && Implicit1Type == TSphere<FReal, 3>::StaticType())
+		};
+
+		static const FPairDispatchEntry& GetPairDispatchEntry(const EImplicitObjectType Implicit0Type, const EImplicitObjectType Implicit1Type)
+		{
+			static const FPairDispatchTable Table;
+			static const FPairDispatchEntry NoEntry = { EPairDispatchHandler::None, false };
+			if ((Implicit0Type < NumPairDispatchTypes) && (Implicit1Type < NumPairDispatchTypes))
 			{
-				ConstructSphereTriangleMeshConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
+				return Table.Entries[Implicit0Type][Implicit1Type];
 			}
-			else if (Implicit0Type == TCapsule<FReal>::StaticType() && Implicit1Type == FTriangleMeshImplicitObject::StaticType())
-			{
-				if (bUseCCD)
-				{
-					ConstructCapsuleTriangleMeshConstraintsSwept(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, DirCCD, LengthCCD, NewConstraints);
-					return;
-				}
+			return NoEntry;
+		}
 
-				ConstructCapsuleTriangleMeshConstraints(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, NewConstraints);
-			}
-			else if (Implicit0Type == FTriangleMeshImplicitObject::StaticType() && Implicit1Type == TCapsule<FReal>::StaticType())
+		template<typename T, int d>
+		void ConstructConstraintsImpl(TGeometryParticleHandle<T, d>* Particle0, TGeometryParticleHandle<T, d>* Particle1, const FImplicitObject* Implicit0, const FImplicitObject* Implicit1, const TRigidTransform<T, d>& Transform0, const TRigidTransform<T, d>& Transform1, const T CullDistance, const FCollisionContext& Context, FCollisionConstraintsArray& NewConstraints)
+		{
+			// @todo(chaos): We use GetInnerType here because TriMeshes are left with their "Instanced" wrapper, unlike all other instanced implicits. Should we strip the instance on Tri Mesh too?
+			EImplicitObjectType Implicit0Type = Implicit0 ? GetInnerType(Implicit0->GetCollisionType()) : ImplicitObjectType::Unknown;
+			EImplicitObjectType Implicit1Type = Implicit1 ? GetInnerType(Implicit1->GetCollisionType()) : ImplicitObjectType::Unknown;
+			T LengthCCD = 0.0f;
+			TVector<T, d> DirCCD(0.0f);
+
+			// Exact shape pairs go through the dispatch table, with the pair swapped into the order the handler expects
+			const FPairDispatchEntry& Dispatch = GetPairDispatchEntry(Implicit0Type, Implicit1Type);
+			if (Dispatch.Handler != EPairDispatchHandler::None)
 			{
-				if (bUseCCD)
+				TGeometryParticleHandle<T, d>* PairParticle0 = Dispatch.bSwap ? Particle1 : Particle0;
+				TGeometryParticleHandle<T, d>* PairParticle1 = Dispatch.bSwap ? Particle0 : Particle1;
+				const FImplicitObject* PairImplicit0 = Dispatch.bSwap ? Implicit1 : Implicit0;
+				const FImplicitObject* PairImplicit1 = Dispatch.bSwap ? Implicit0 : Implicit1;
+				const TRigidTransform<T, d>& PairTransform0 = Dispatch.bSwap ? Transform1 : Transform0;
+				const TRigidTransform<T, d>& PairTransform1 = Dispatch.bSwap ? Transform0 : Transform1;
+
+				switch (Dispatch.Handler)
 				{
-					ConstructCapsuleTriangleMeshConstraintsSwept(Particle0, Particle1, Implicit0, Implicit1, Transform0, Transform1, CullDistance, DirCCD, LengthCCD, NewConstraints);
-					return;
+				case EPairDispatchHandler::BoxBox:
+					ConstructBoxBoxConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::BoxHeightField:
+					ConstructBoxHeightFieldConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::BoxPlane:
+					ConstructBoxPlaneConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::BoxTriMesh:
+					ConstructBoxTriangleMeshConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SphereSphere:
+					ConstructSphereSphereConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SphereHeightField:
+					ConstructSphereHeightFieldConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SpherePlane:
+					ConstructSpherePlaneConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SphereBox:
+					ConstructSphereBoxConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SphereCapsule:
+					ConstructSphereCapsuleConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::SphereTriMesh:
+					ConstructSphereTriangleMeshConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::CapsuleCapsule:
+					ConstructCapsuleCapsuleConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					break;
+				case EPairDispatchHandler::CapsuleBox:
+					ConstructCapsuleBoxConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, Context, NewConstraints);
+					break;
+				case EPairDispatchHandler::CapsuleHeightField:
+					if (UseCCD(Particle0, Particle1, Implicit0, DirCCD, LengthCCD))
+					{
+						ConstructCapsuleHeightFieldConstraintsSwept(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, DirCCD, LengthCCD, NewConstraints);
+					}
+					else
+					{
+						ConstructCapsuleHeightFieldConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					}
+					break;
+				case EPairDispatchHandler::CapsuleTriMesh:
+					if (UseCCD(Particle0, Particle1, Implicit0, DirCCD, LengthCCD))
+					{
+						ConstructCapsuleTriangleMeshConstraintsSwept(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, DirCCD, LengthCCD, NewConstraints);
+					}
+					else
+					{
+						ConstructCapsuleTriangleMeshConstraints(PairParticle0, PairParticle1, PairImplicit0, PairImplicit1, PairTransform0, PairTransform1, CullDistance, NewConstraints);
+					}
+					break;
+				default:
+					check(false);
+					break;
 				}
-
-				ConstructCapsuleTriangleMeshConstraints(Particle1, Particle0, Implicit1, Implicit0, Transform1, Transform0, CullDistance, NewConstraints);
+				return;
 			}
-			else if (bIsConvex0 && Implicit1Type == THeightField<FReal>::StaticType())
+
+			bool bIsConvex0 = Implicit0 && Implicit0->IsConvex() && Implicit0Type != ImplicitObjectType::LevelSet;
+			bool bIsConvex1 = Implicit1 && Implicit1->IsConvex() && Implicit1Type != ImplicitObjectType::LevelSet;
+			bool bUseCCD = (bIsConvex0 || bIsConvex1) && UseCCD(Particle0, Particle1, Implicit0, DirCCD, LengthCCD);
+
+			if (bIsConvex0 && Implicit1Type == THeightField<FReal>::StaticType())
 			{
 				if (bUseCCD)
 				{
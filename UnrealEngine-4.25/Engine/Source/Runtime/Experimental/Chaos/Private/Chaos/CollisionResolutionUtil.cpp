@@ -99,9 +99,9 @@ namespace Chaos
 		template <typename T, int d>
 		bool SampleObjectNoNormal(const FImplicitObject& Object, const TRigidTransform<T, d>& ObjectTransform, const TRigidTransform<T, d>& SampleToObjectTransform, const TVector<T, d>& SampleParticle, T Thickness, TRigidBodyPointContactConstraint<float, 3>& Constraint)
 		{
+			// Only phi is needed here; the normal is recomputed for the deepest particle afterwards
 			TVector<T, d> LocalPoint = SampleToObjectTransform.TransformPositionNoScale(SampleParticle);
-			TVector<T, d> LocalNormal;
-			T LocalPhi = Object.PhiWithNormal(LocalPoint, LocalNormal);
+			T LocalPhi = Object.SignedDistance(LocalPoint);
 
 			TCollisionContact<T, d> & Contact = Constraint.Manifold;
 			if (LocalPhi < Contact.Phi)
@@ -115,9 +115,9 @@ namespace Chaos
 		template <typename T, int d>
 		bool SampleObjectNormalAverageHelper(const FImplicitObject& Object, const TRigidTransform<T, d>& ObjectTransform, const TRigidTransform<T, d>& SampleToObjectTransform, const TVector<T, d>& SampleParticle, T Thickness, T& TotalThickness, TRigidBodyPointContactConstraint<float, 3>& Constraint)
 		{
+			// Only phi is needed here; the normal is recomputed at the averaged location afterwards
 			TVector<T, d> LocalPoint = SampleToObjectTransform.TransformPositionNoScale(SampleParticle);
-			TVector<T, d> LocalNormal;
-			T LocalPhi = Object.PhiWithNormal(LocalPoint, LocalNormal);
+			T LocalPhi = Object.SignedDistance(LocalPoint);
 			T LocalThickness = LocalPhi - Thickness;
 
 			TCollisionContact<T, d> & Contact = Constraint.Manifold;
@@ -434,8 +434,16 @@ namespace Chaos
 				else
 				{
 					//QUICK_SCOPE_CYCLE_COUNTER(STAT_Other);
+					const bool bCullByBounds = Object.HasBoundingBox();
+					TAABB<float, 3> CullBox = bCullByBounds ? Object.BoundingBox() : TAABB<float, 3>();
+					CullBox.Thicken(Thickness);
 					for (int32 i = 0; i < NumParticles; ++i)
 					{
+						// A sample outside the thickened bounds can't be within Thickness of the surface
+						if (bCullByBounds && !CullBox.Contains(SampleToObjectTM.TransformPositionNoScale(SampleParticles.X(i))))
+						{
+							continue;
+						}
 						if (NormalAveraging && UpdateType != ECollisionUpdateType::Any)
 						{
 							SampleObjectNormalAverageHelper(Object, ObjectTransform, SampleToObjectTM, SampleParticles.X(i), Thickness, TotalThickness, AvgConstraint);
@@ -542,8 +550,16 @@ namespace Chaos
 			else
 			{
 				SCOPE_CYCLE_COUNTER(STAT_UpdateLevelsetAll);
+				const bool bCullByBounds = Object.HasBoundingBox();
+				TAABB<T, d> CullBox = bCullByBounds ? Object.BoundingBox() : TAABB<T, d>();
+				CullBox.Thicken(Thickness);
 				for (int32 i = 0; i < NumParticles; ++i)
 				{
+					// A sample outside the thickened bounds can't be within Thickness of the surface
+					if (bCullByBounds && !CullBox.Contains(SampleToObjectTM.TransformPositionNoScale(SampleParticles.X(i))))
+					{
+						continue;
+					}
 					if (NormalAveraging && UpdateType != ECollisionUpdateType::Any)	//if we just want one don't bother with normal
 					{
 						const bool bInside = SampleObjectNormalAverageHelper(Object, ObjectTransform, SampleToObjectTM, SampleParticles.X(i), Thickness, TotalThickness, AvgConstraint);
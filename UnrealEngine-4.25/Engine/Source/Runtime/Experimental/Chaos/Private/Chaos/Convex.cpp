@@ -14,12 +14,13 @@ namespace Chaos
 		for (int32 Idx = 0; Idx < Planes.Num(); ++Idx)
 		{
 			const TPlaneConcrete<FReal, 3>& Plane = Planes[Idx];
-			const FReal Distance = Plane.SignedDistance(Position);
-			if (FMath::Abs(Distance) < SearchDist)
+			// TPlane has an override for Normal() that doesn't call PhiWithNormal().
+			// Only planes more opposing than the best so far need the distance test.
+			const FReal Dot = FVec3::DotProduct(Plane.Normal(), UnitDir);
+			if (Dot < MostOpposingDot)
 			{
-				// TPlane has an override for Normal() that doesn't call PhiWithNormal().
-				const FReal Dot = FVec3::DotProduct(Plane.Normal(), UnitDir);
-				if (Dot < MostOpposingDot)
+				const FReal Distance = Plane.SignedDistance(Position);
+				if (FMath::Abs(Distance) < SearchDist)
 				{
 					MostOpposingDot = Dot;
 					MostOpposingIdx = Idx;
@@ -40,21 +41,22 @@ namespace Chaos
 		//
 
 		int32 ReturnIndex = INDEX_NONE;
-		TSet<int32> IncludedParticles;
+		const int32 NumSurfaceParticles = (int32)SurfaceParticles.Size();
+		TBitArray<TInlineAllocator<4>> IncludedParticles(false, NumSurfaceParticles);
 		for (int32 Idx = 0; Idx < Planes.Num(); ++Idx)
 		{
 			const TPlaneConcrete<FReal, 3>& Plane = Planes[Idx];
 			FReal AbsOfSignedDistance = FMath::Abs(Plane.SignedDistance(Position));
 			if (AbsOfSignedDistance < SearchDist)
 			{
-				for (int32 Fdx = 0; Fdx < (int32)SurfaceParticles.Size(); Fdx++)
+				for (int32 Fdx = 0; Fdx < NumSurfaceParticles; Fdx++)
 				{
-					if (!IncludedParticles.Contains(Fdx))
+					if (!IncludedParticles[Fdx])
 					{
 						if (FMath::Abs(Plane.SignedDistance(SurfaceParticles.X(Fdx))) < SearchDist)
 						{
 							FaceVertices.Add(SurfaceParticles.X(Fdx));
-							IncludedParticles.Add(Fdx);
+							IncludedParticles[Fdx] = true;
 						}
 					}
 				}
@@ -2,6 +2,8 @@
 // Parts of this file are adapted from PhysBAM under Copyright http://physbam.stanford.edu/links/backhistdisclaimcopy.html
 #include "Chaos/FFT.h"
 
+#include "Chaos/Framework/Parallel.h"
+
 using namespace Chaos;
 
 template<class T>
@@ -195,12 +197,71 @@ void InverseTransformHelper(const TUniformGrid<T, 3>& Grid, TArrayND<TVector<T,
 		}
 	}
 }
+// Inverse transform two Hermitian spectra with a single complex transform.  Both
+// results are real, so packing u + i*v leaves u in the real and v in the
+// imaginary part of the output.
+template<class T>
+void InverseTransformPairHelper(const TUniformGrid<T, 3>& Grid, TArrayND<TVector<T, 3>, 3>& Velocity, const TArrayND<Complex<T>, 3>& u, const TArrayND<Complex<T>, 3>& v, const int32 index0, const int32 index1, const bool Normalize)
+{
+	int32 Size = Grid.Counts().Product();
+	TArray<float> Data;
+	Data.SetNum(2 * Size);
+	int32 k = 0;
+	for (int32 i = 0; i < Grid.Counts()[0]; ++i)
+	{
+		int32 negi = (i == 0) ? 0 : Grid.Counts()[0] - i;
+		for (int32 j = 0; j < Grid.Counts()[1]; ++j)
+		{
+			int32 negj = (j == 0) ? 0 : Grid.Counts()[1] - j;
+			for (int32 ij = 0; ij <= Grid.Counts()[2] / 2; ++ij)
+			{
+				const Complex<T>& U = u(i, j, ij);
+				const Complex<T>& V = v(i, j, ij);
+				Data[k++] = (float)U.Real() - (float)V.Imaginary();
+				Data[k++] = (float)U.Imaginary() + (float)V.Real();
+			}
+			for (int32 ij = Grid.Counts()[2] / 2 + 1; ij < Grid.Counts()[2]; ++ij)
+			{
+				int32 negij = Grid.Counts()[2] - ij;
+				// Conjugates of the mirrored coefficients
+				const Complex<T>& U = u(negi, negj, negij);
+				const Complex<T>& V = v(negi, negj, negij);
+				Data[k++] = (float)U.Real() + (float)V.Imaginary();
+				Data[k++] = -(float)U.Imaginary() + (float)V.Real();
+			}
+		}
+	}
+	NRFourn(1, Grid.Counts(), Data);
+	k = 0;
+	const T multiplier = Normalize ? ((T)1 / (T)Size) : 1;
+	for (int32 i = 0; i < Grid.Counts()[0]; ++i)
+	{
+		for (int32 j = 0; j < Grid.Counts()[1]; ++j)
+		{
+			for (int32 ij = 0; ij < Grid.Counts()[2]; ++ij)
+			{
+				Velocity(i, j, ij)[index0] = Data[k++] * multiplier;
+				Velocity(i, j, ij)[index1] = Data[k++] * multiplier;
+			}
+		}
+	}
+}
 template<class T>
 void TFFT<T, 3>::InverseTransform(const TUniformGrid<T, 3>& Grid, TArrayND<TVector<T, 3>, 3>& Velocity, const TArrayND<Complex<T>, 3>& u, const TArrayND<Complex<T>, 3>& v, const TArrayND<Complex<T>, 3>& w, const bool Normalize)
 {
-	InverseTransformHelper(Grid, Velocity, u, 0, Normalize);
-	InverseTransformHelper(Grid, Velocity, v, 1, Normalize);
-	InverseTransformHelper(Grid, Velocity, w, 2, Normalize);
+	// u and v share one complex transform, w runs alongside it.  Each writes a
+	// different velocity component.
+	PhysicsParallelFor(2, [&](int32 Pass)
+	{
+		if (Pass == 0)
+		{
+			InverseTransformPairHelper(Grid, Velocity, u, v, 0, 1, Normalize);
+		}
+		else
+		{
+			InverseTransformHelper(Grid, Velocity, w, 2, Normalize);
+		}
+	});
 }
 
 template<class T>
@@ -236,12 +297,62 @@ void TransformHelper(const TUniformGrid<T, 3>& Grid, const TArrayND<TVector<T, 3
 		}
 	}
 }
+// Transform two real components with a single complex transform of
+// z = u + i*v, then separate the spectra using their Hermitian symmetry:
+// U(k) = (Z(k) + conj(Z(-k))) / 2 and V(k) = (Z(k) - conj(Z(-k))) / 2i.
+template<class T>
+void TransformPairHelper(const TUniformGrid<T, 3>& Grid, const TArrayND<TVector<T, 3>, 3>& Velocity, TArrayND<Complex<T>, 3>& u, TArrayND<Complex<T>, 3>& v, const int32 index0, const int32 index1)
+{
+	int32 Size = Grid.Counts().Product();
+	TArray<float> Data;
+	Data.SetNum(2 * Size);
+	int32 k = 0;
+	for (int32 i = 0; i < Grid.Counts()[0]; ++i)
+	{
+		for (int32 j = 0; j < Grid.Counts()[1]; ++j)
+		{
+			for (int32 ij = 0; ij < Grid.Counts()[2]; ++ij)
+			{
+				Data[k++] = (float)Velocity(i, j, ij)[index0];
+				Data[k++] = (float)Velocity(i, j, ij)[index1];
+			}
+		}
+	}
+	NRFourn(-1, Grid.Counts(), Data);
+	for (int32 i = 0; i < Grid.Counts()[0]; ++i)
+	{
+		int32 negi = (i == 0) ? 0 : Grid.Counts()[0] - i;
+		for (int32 j = 0; j < Grid.Counts()[1]; ++j)
+		{
+			int32 negj = (j == 0) ? 0 : Grid.Counts()[1] - j;
+			for (int32 ij = 0; ij <= Grid.Counts()[2] / 2; ++ij)
+			{
+				int32 negij = (ij == 0) ? 0 : Grid.Counts()[2] - ij;
+				const int32 PosIdx = 2 * ((i * Grid.Counts()[1] + j) * Grid.Counts()[2] + ij);
+				const int32 NegIdx = 2 * ((negi * Grid.Counts()[1] + negj) * Grid.Counts()[2] + negij);
+				const float ZRe = Data[PosIdx], ZIm = Data[PosIdx + 1];
+				const float NegRe = Data[NegIdx], NegIm = Data[NegIdx + 1];
+				u(i, j, ij) = Complex<T>((ZRe + NegRe) / 2, (ZIm - NegIm) / 2);
+				v(i, j, ij) = Complex<T>((ZIm + NegIm) / 2, (NegRe - ZRe) / 2);
+			}
+		}
+	}
+}
 template<class T>
 void TFFT<T, 3>::Transform(const TUniformGrid<T, 3>& Grid, const TArrayND<TVector<T, 3>, 3>& Velocity, TArrayND<Complex<T>, 3>& u, TArrayND<Complex<T>, 3>& v, TArrayND<Complex<T>, 3>& w)
 {
-	TransformHelper(Grid, Velocity, u, 0);
-	TransformHelper(Grid, Velocity, v, 1);
-	TransformHelper(Grid, Velocity, w, 2);
+	// u and v share one complex transform, w runs alongside it.
+	PhysicsParallelFor(2, [&](int32 Pass)
+	{
+		if (Pass == 0)
+		{
+			TransformPairHelper(Grid, Velocity, u, v, 0, 1);
+		}
+		else
+		{
+			TransformHelper(Grid, Velocity, w, 2);
+		}
+	});
 }
 
 template class Chaos::TFFT<float, 3>;
@@ -207,6 +207,8 @@ namespace Chaos
 		TMap<const FImplicitObject*, int32>& Mapping = ImplicitShapeMap[Index];
 		TShapesArray<T, d>& ShapeArray = MShapesArray[Index];
 		Mapping.Reset();
+		// Each shape maps its geometry and possibly an inner child
+		Mapping.Reserve(2 * ShapeArray.Num());
 
 		for (int32 ShapeIndex = 0; ShapeIndex < ShapeArray.Num(); ++ ShapeIndex)
 		{
@@ -222,7 +224,19 @@ namespace Chaos
 
 		if (MGeometry[Index])
 		{
-			int32 CurrentShapeIndex = INDEX_NONE;
+			// Map whichever of the object and its inner child is missing to the shape of the other.
+			// The shape index is copied out before Add since adding may reallocate the map.
+			auto MapObjectAndChild = [&Mapping](const FImplicitObject* ImplicitObject, const FImplicitObject* ImplicitChildObject)
+			{
+				if (const int32* ObjectShapeIndex = Mapping.Find(ImplicitObject))
+				{
+					Mapping.Add(ImplicitChildObject, CopyTemp(*ObjectShapeIndex));
+				}
+				else if (const int32* ChildShapeIndex = Mapping.Find(ImplicitChildObject))
+				{
+					Mapping.Add(ImplicitObject, CopyTemp(*ChildShapeIndex));
+				}
+			};
 
 			if (const auto* Union = MGeometry[Index]->template GetObject<FImplicitObjectUnion>())
 			{
@@ -232,15 +246,7 @@ namespace Chaos
 					{
 						if (const FImplicitObject* ImplicitChildObject = Utilities::ImplicitChildHelper(ImplicitObject.Get()))
 						{
-							if (ImplicitShapeMap[Index].Contains(ImplicitObject.Get()))
-							{
-								ImplicitShapeMap[Index].Add(ImplicitChildObject, CopyTemp(ImplicitShapeMap[Index][ImplicitObject.Get()]));
-							}
-							else if (ImplicitShapeMap[Index].Contains(ImplicitChildObject))
-							{
-								ImplicitShapeMap[Index].Add(ImplicitObject.Get(), CopyTemp(ImplicitShapeMap[Index][ImplicitChildObject]));
-							}
-							
+							MapObjectAndChild(ImplicitObject.Get(), ImplicitChildObject);
 						}
 					}
 				}
@@ -249,18 +255,9 @@ namespace Chaos
 			{
 				if (const FImplicitObject* ImplicitChildObject = Utilities::ImplicitChildHelper(MGeometry[Index].Get()))
 				{
-					if (ImplicitShapeMap[Index].Contains(MGeometry[Index].Get()))
-					{
-						ImplicitShapeMap[Index].Add(ImplicitChildObject, CopyTemp(ImplicitShapeMap[Index][MGeometry[Index].Get()]));
-					}
-					else if (ImplicitShapeMap[Index].Contains(ImplicitChildObject))
-					{
-						ImplicitShapeMap[Index].Add(MGeometry[Index].Get(), CopyTemp(ImplicitShapeMap[Index][ImplicitChildObject]));
-					}
-					
+					MapObjectAndChild(MGeometry[Index].Get(), ImplicitChildObject);
 				}
 			}
-
 		}
 	}
 
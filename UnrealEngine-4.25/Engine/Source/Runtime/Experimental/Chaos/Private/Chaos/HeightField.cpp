@@ -8,6 +8,7 @@
 #include "Chaos/GeometryQueries.h"
 #include "HAL/IConsoleManager.h"
 #include "HAL/PlatformMisc.h"
+#include "Misc/MemStack.h"
 #include "Chaos/Triangle.h"
 
 namespace Chaos
@@ -379,7 +380,24 @@ namespace Chaos
 				const int32 NumCells = NumHeights - NumRows - NumCols + 1;
 				ensure(MaterialIndexView.Num() == NumCells);
 				OutData.MaterialIndices.Empty();
-				OutData.MaterialIndices.Append(MaterialIndexView.GetData(), MaterialIndexView.Num());
+
+				// Landscapes commonly use a single material everywhere, in which case one entry covers every cell.
+				// Holes are stored per cell so a uniform hole material is kept expanded.
+				const uint8 FirstMaterial = MaterialIndexView[0];
+				bool bUniformMaterial = FirstMaterial != TNumericLimits<uint8>::Max();
+				for(int32 CellIdx = 1; bUniformMaterial && CellIdx < MaterialIndexView.Num(); ++CellIdx)
+				{
+					bUniformMaterial = MaterialIndexView[CellIdx] == FirstMaterial;
+				}
+
+				if(bUniformMaterial)
+				{
+					OutData.MaterialIndices.Add(FirstMaterial);
+				}
+				else
+				{
+					OutData.MaterialIndices.Append(MaterialIndexView.GetData(), MaterialIndexView.Num());
+				}
 			}
 		}
 	}
@@ -570,6 +588,12 @@ namespace Chaos
 	template<typename T>
 	uint8 Chaos::THeightField<T>::GetMaterialIndex(int32 InIndex) const
 	{
+		// A single entry is shared by every cell (see BuildGeomData)
+		if(GeomData.MaterialIndices.Num() == 1)
+		{
+			return GeomData.MaterialIndices[0];
+		}
+
 		if(CHAOS_ENSURE(InIndex >= 0 && InIndex < GeomData.MaterialIndices.Num()))
 		{
 			return GeomData.MaterialIndices[InIndex];
@@ -864,6 +888,7 @@ namespace Chaos
 		return false;
 	}
 
+	// The bits live on the calling thread's FMemStack, users must hold an FMemMark while the set is alive
 	struct F2DGridSet
 	{
 		F2DGridSet(TVector<int32, 2> Size)
@@ -872,8 +897,8 @@ namespace Chaos
 		{
 			int32 BitsNeeded = NumX * NumY;
 			DataSize = 1 + (BitsNeeded) / 8;
-			Data = MakeUnique<uint8[]>(DataSize);
-			FMemory::Memzero(Data.Get(), DataSize);
+			Data = (uint8*)FMemStack::Get().PushBytes(DataSize, alignof(uint8));
+			FMemory::Memzero(Data, DataSize);
 		}
 
 		bool Contains(const TVector<int32, 2>& Coordinate)
@@ -899,7 +924,7 @@ namespace Chaos
 	private:
 		int32 NumX;
 		int32 NumY;
-		TUniquePtr<uint8[]> Data;
+		uint8* Data;
 		int32 DataSize;
 	};
 
@@ -949,8 +974,10 @@ namespace Chaos
 			};
 
 			// Tracking data for cells to query (similar to bounding volume approach)
+			// Scratch comes from the thread's mem stack and is released in one go when the sweep ends
+			FMemMark Mark(FMemStack::Get());
 			F2DGridSet Seen(FlatGrid.Counts());
-			TArray<FQueueEntry> Queue;
+			TArray<FQueueEntry, TMemStackAllocator<>> Queue;
 			Queue.Add({StartCell, -1});
 			Seen.Add(StartCell);
 
@@ -1134,6 +1161,43 @@ namespace Chaos
 		return false;
 	}
 
+	// Visits the grid cells under a flat (XY) query box without building an intersection list.
+	// CellFunction returns false to stop the iteration early.
+	template<typename T, typename FCellFunction>
+	void ForEachGridCellInFlatBounds(const TUniformGrid<T, 2>& FlatGrid, const TVector<T, 2>& FlatBoundsMin, const TVector<T, 2>& FlatBoundsMax, const TVector<T, 2>& QueryMin, const TVector<T, 2>& QueryMax, const TVector<T, 2>& Scale2D, const FCellFunction& CellFunction)
+	{
+		TVector<T, 2> ClampedMin, ClampedMax;
+		for(int32 Axis = 0; Axis < 2; ++Axis)
+		{
+			ClampedMin[Axis] = FMath::Clamp(QueryMin[Axis], FlatBoundsMin[Axis], FlatBoundsMax[Axis]);
+			ClampedMax[Axis] = FMath::Clamp(QueryMax[Axis], FlatBoundsMin[Axis], FlatBoundsMax[Axis]);
+		}
+
+		const TVector<int32, 2> MinCell = FlatGrid.ClampIndex(FlatGrid.Cell(ClampedMin / Scale2D));
+		const TVector<int32, 2> MaxCell = FlatGrid.ClampIndex(FlatGrid.Cell(ClampedMax / Scale2D));
+
+		// We want to capture the first cell (delta == 0) as well
+		for(int32 CurrX = MinCell[0]; CurrX <= MaxCell[0]; ++CurrX)
+		{
+			for(int32 CurrY = MinCell[1]; CurrY <= MaxCell[1]; ++CurrY)
+			{
+				if(!CellFunction(TVector<int32, 2>(CurrX, CurrY)))
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	// Conservative rejection of a cell whose height range can't reach the query's height range
+	template<typename T>
+	bool CellHeightRangeOverlaps(const TVector<T, 3> Points[4], const T QueryMinZ, const T QueryMaxZ)
+	{
+		const T CellMinZ = FMath::Min(FMath::Min(Points[0][2], Points[1][2]), FMath::Min(Points[2][2], Points[3][2]));
+		const T CellMaxZ = FMath::Max(FMath::Max(Points[0][2], Points[1][2]), FMath::Max(Points[2][2], Points[3][2]));
+		return CellMaxZ >= QueryMinZ && CellMinZ <= QueryMaxZ;
+	}
+
 	template<typename T>
 	bool Chaos::THeightField<T>::GetGridIntersections(FBounds2D InFlatBounds, TArray<TVector<int32, 2>>& OutInterssctions) const
 	{
@@ -1142,24 +1206,11 @@ namespace Chaos
 		const FBounds2D FlatBounds = GetFlatBounds();
 		const TVector<T, 2> Scale2D(GeomData.Scale[0], GeomData.Scale[1]);
 
-		InFlatBounds.Min = FlatBounds.Clamp(InFlatBounds.Min);
-		InFlatBounds.Max = FlatBounds.Clamp(InFlatBounds.Max);
-		TVector<int32, 2> MinCell = FlatGrid.Cell(InFlatBounds.Min / Scale2D);
-		TVector<int32, 2> MaxCell = FlatGrid.Cell(InFlatBounds.Max / Scale2D);
-		MinCell = FlatGrid.ClampIndex(MinCell);
-		MaxCell = FlatGrid.ClampIndex(MaxCell);
-
-		// We want to capture the first cell (delta == 0) as well
-		const int32 NumX = MaxCell[0] - MinCell[0] + 1;
-		const int32 NumY = MaxCell[1] - MinCell[1] + 1;
-
-		for(int32 CurrX = 0; CurrX < NumX; ++CurrX)
+		ForEachGridCellInFlatBounds(FlatGrid, FlatBounds.Min, FlatBounds.Max, InFlatBounds.Min, InFlatBounds.Max, Scale2D, [&OutInterssctions](const TVector<int32, 2>& Cell)
 		{
-			for(int32 CurrY = 0; CurrY < NumY; ++CurrY)
-			{
-				OutInterssctions.Add(FlatGrid.ClampIndex(TVector<int32, 2>(MinCell[0] + CurrX, MinCell[1] + CurrY)));
-			}
-		}
+			OutInterssctions.Add(Cell);
+			return true;
+		});
 
 		return OutInterssctions.Num() > 0;
 	}
@@ -1203,32 +1254,29 @@ namespace Chaos
 		TAABB<T, 3> QueryBounds(Point, Point);
 		QueryBounds.Thicken(Thickness);
 
-		FBounds2D FlatQueryBounds;
-		FlatQueryBounds.Min = TVector<T, 2>(QueryBounds.Min()[0], QueryBounds.Min()[1]);
-		FlatQueryBounds.Max = TVector<T, 2>(QueryBounds.Max()[0], QueryBounds.Max()[1]);
+		const FBounds2D FlatBounds = GetFlatBounds();
+		const TVector<T, 2> Scale2D(GeomData.Scale[0], GeomData.Scale[1]);
+		const TVector<T, 2> FlatQueryMin(QueryBounds.Min()[0], QueryBounds.Min()[1]);
+		const TVector<T, 2> FlatQueryMax(QueryBounds.Max()[0], QueryBounds.Max()[1]);
 
-		TArray<TVector<int32, 2>> Intersections;
 		TVector<T, 3> Points[4];
+		bool bOverlaps = false;
 
-		GetGridIntersections(FlatQueryBounds, Intersections);
-
-		for(const TVector<int32, 2>& Cell : Intersections)
+		ForEachGridCellInFlatBounds(FlatGrid, FlatBounds.Min, FlatBounds.Max, FlatQueryMin, FlatQueryMax, Scale2D, [&](const TVector<int32, 2>& Cell)
 		{
 			const int32 SingleIndex = Cell[1] * (GeomData.NumCols) + Cell[0];
 			GeomData.GetPointsScaled(SingleIndex, Points);
 
-			if(OverlapTriangle(Points[0], Points[1], Points[3]))
+			if(!CellHeightRangeOverlaps(Points, QueryBounds.Min()[2], QueryBounds.Max()[2]))
 			{
 				return true;
 			}
 
-			if(OverlapTriangle(Points[0], Points[3], Points[2]))
-			{
-				return true;
-			}
-		}
+			bOverlaps = OverlapTriangle(Points[0], Points[1], Points[3]) || OverlapTriangle(Points[0], Points[3], Points[2]);
+			return !bOverlaps;
+		});
 		
-		return false;
+		return bOverlaps;
 	}
 
 
@@ -1267,18 +1315,16 @@ namespace Chaos
 		QueryBounds.Thicken(Thickness);
 		QueryBounds = QueryBounds.TransformedAABB(QueryTM);
 
-		FBounds2D FlatQueryBounds;
-		FlatQueryBounds.Min = TVector<T, 2>(QueryBounds.Min()[0], QueryBounds.Min()[1]);
-		FlatQueryBounds.Max = TVector<T, 2>(QueryBounds.Max()[0], QueryBounds.Max()[1]);
+		const FBounds2D FlatBounds = GetFlatBounds();
+		const TVector<T, 2> Scale2D(GeomData.Scale[0], GeomData.Scale[1]);
+		const TVector<T, 2> FlatQueryMin(QueryBounds.Min()[0], QueryBounds.Min()[1]);
+		const TVector<T, 2> FlatQueryMax(QueryBounds.Max()[0], QueryBounds.Max()[1]);
 
-		TArray<TVector<int32, 2>> Intersections;
 		TVector<T, 3> Points[4];
 
-		GetGridIntersections(FlatQueryBounds, Intersections);
-
 		T LocalContactPhi = FLT_MAX;
 		TVector<T, 3> LocalContactLocation, LocalContactNormal;
-		for (const TVector<int32, 2>& Cell : Intersections)
+		ForEachGridCellInFlatBounds(FlatGrid, FlatBounds.Min, FlatBounds.Max, FlatQueryMin, FlatQueryMax, Scale2D, [&](const TVector<int32, 2>& Cell)
 		{
 			const int32 SingleIndex = Cell[1] * GeomData.NumCols + Cell[0];
 			const int32 CellIndex = Cell[1] * (GeomData.NumCols - 1) + Cell[0];
@@ -1286,12 +1332,18 @@ namespace Chaos
 			// Check for holes and skip checking if we'll never collide
 			if(GeomData.MaterialIndices.IsValidIndex(CellIndex) && GeomData.MaterialIndices[CellIndex] == TNumericLimits<uint8>::Max())
 			{
-				continue;
+				return true;
 			}
 
 			// The triangle is solid so proceed to test it
 			GeomData.GetPointsScaled(SingleIndex, Points);
 
+			// Cells entirely above or below the query can't produce a contact
+			if(!CellHeightRangeOverlaps(Points, QueryBounds.Min()[2], QueryBounds.Max()[2]))
+			{
+				return true;
+			}
+
 			if (OverlapTriangle(Points[0], Points[1], Points[3], LocalContactLocation, LocalContactNormal, LocalContactPhi))
 			{
 				if (LocalContactPhi < ContactPhi)
@@ -1311,7 +1363,9 @@ namespace Chaos
 					ContactNormal = LocalContactNormal;
 				}
 			}
-		}
+
+			return true;
+		});
 
 		if(ContactPhi < 0)
 			return true;
@@ -1417,27 +1471,30 @@ namespace Chaos
 		QueryBounds.Thicken(Thickness);
 		QueryBounds = QueryBounds.TransformedAABB(QueryTM);
 
-		FBounds2D FlatQueryBounds;
-		FlatQueryBounds.Min = TVector<T, 2>(QueryBounds.Min()[0], QueryBounds.Min()[1]);
-		FlatQueryBounds.Max = TVector<T, 2>(QueryBounds.Max()[0], QueryBounds.Max()[1]);
+		const FBounds2D FlatBounds = GetFlatBounds();
+		const TVector<T, 2> Scale2D(GeomData.Scale[0], GeomData.Scale[1]);
+		const TVector<T, 2> FlatQueryMin(QueryBounds.Min()[0], QueryBounds.Min()[1]);
+		const TVector<T, 2> FlatQueryMax(QueryBounds.Max()[0], QueryBounds.Max()[1]);
 
-		TArray<TVector<int32, 2>> Intersections;
 		TVector<T, 3> Points[4];
 
-		GetGridIntersections(FlatQueryBounds, Intersections);
-
 		bool bOverlaps = false;
-		for(const TVector<int32, 2>& Cell : Intersections)
+		ForEachGridCellInFlatBounds(FlatGrid, FlatBounds.Min, FlatBounds.Max, FlatQueryMin, FlatQueryMax, Scale2D, [&](const TVector<int32, 2>& Cell)
 		{
 			const int32 SingleIndex = Cell[1] * (GeomData.NumCols) + Cell[0];
 			GeomData.GetPointsScaled(SingleIndex, Points);
 
+			if(!CellHeightRangeOverlaps(Points, QueryBounds.Min()[2], QueryBounds.Max()[2]))
+			{
+				return true;
+			}
+
 			if(OverlapTriangle(Points[0], Points[1], Points[3], OutMTD))
 			{
 				bOverlaps = true;
 				if (!OutMTD)
 				{
-					return true;
+					return false;
 				}
 			}
 
@@ -1446,10 +1503,12 @@ namespace Chaos
 				bOverlaps = true;
 				if (!OutMTD)
 				{
-					return true;
+					return false;
 				}
 			}
-		}
+
+			return true;
+		});
 
 		return bOverlaps;
 	}
@@ -20,6 +20,70 @@
 
 using namespace Chaos;
 
+namespace
+{
+	// Calls Func with Object downcast to its concrete type, so that loops evaluating the same implicit at many points
+	// pick the type once and then make direct calls the compiler can inline. Unlike Utilities::CastHelper this never
+	// unwraps transformed or scaled objects, and anything not listed is passed through as a plain FImplicitObject.
+	template <typename FFunc>
+	FORCEINLINE_DEBUGGABLE void DispatchOnConcreteType(const FImplicitObject& Object, const FFunc& Func)
+	{
+		const EImplicitObjectType Type = Object.GetType();
+		if (IsScaled(Type))
+		{
+			switch (GetInnerType(Type))
+			{
+			case ImplicitObjectType::Convex: Func(static_cast<const TImplicitObjectScaled<FConvex>&>(Object)); return;
+			case ImplicitObjectType::TriangleMesh: Func(static_cast<const TImplicitObjectScaled<FTriangleMeshImplicitObject>&>(Object)); return;
+			default: Func(Object); return;
+			}
+		}
+
+		switch (Type)
+		{
+		case ImplicitObjectType::Sphere: Func(static_cast<const TSphere<FReal, 3>&>(Object)); return;
+		case ImplicitObjectType::Box: Func(static_cast<const TBox<FReal, 3>&>(Object)); return;
+		case ImplicitObjectType::Plane: Func(static_cast<const TPlane<FReal, 3>&>(Object)); return;
+		case ImplicitObjectType::Capsule: Func(static_cast<const TCapsule<FReal>&>(Object)); return;
+		case ImplicitObjectType::Convex: Func(static_cast<const FConvex&>(Object)); return;
+		case ImplicitObjectType::LevelSet: Func(static_cast<const TLevelSet<FReal, 3>&>(Object)); return;
+		case ImplicitObjectType::TaperedCylinder: Func(static_cast<const TTaperedCylinder<FReal>&>(Object)); return;
+		case ImplicitObjectType::Cylinder: Func(static_cast<const TCylinder<FReal>&>(Object)); return;
+		default: Func(Object); return;
+		}
+	}
+
+	// Qualified calls on the concrete type bypass the vtable. The FImplicitObject overloads are the fallback for
+	// types the dispatch above doesn't know about and keep the virtual call.
+	template <typename TConcrete>
+	FORCEINLINE FReal DirectPhiWithNormal(const TConcrete& Object, const FVec3& X, FVec3& Normal)
+	{
+		return Object.TConcrete::PhiWithNormal(X, Normal);
+	}
+
+	FORCEINLINE FReal DirectPhiWithNormal(const FImplicitObject& Object, const FVec3& X, FVec3& Normal)
+	{
+		return Object.PhiWithNormal(X, Normal);
+	}
+
+	template <typename TConcrete, typename FGetParticleIndex>
+	void FindDeepestParticle(const TConcrete& Object, const TParticles<FReal, 3>& Particles, const FMatrix33& OtherToLocalTransform, const int32 NumCandidates, const FGetParticleIndex& GetParticleIndex, FReal& Phi, FVec3& Point)
+	{
+		for (int32 Candidate = 0; Candidate < NumCandidates; ++Candidate)
+		{
+			const int32 i = GetParticleIndex(Candidate);
+			FVec3 LocalPoint = OtherToLocalTransform.TransformPosition(Particles.X(i));
+			FVec3 LocalNormal;
+			FReal LocalPhi = DirectPhiWithNormal(Object, LocalPoint, LocalNormal);
+			if (LocalPhi < Phi)
+			{
+				Phi = LocalPhi;
+				Point = Particles.X(i);
+			}
+		}
+	}
+}
+
 FImplicitObject::FImplicitObject(int32 Flags, EImplicitObjectType InType)
     : Type(InType)
 	, CollisionType(InType)
@@ -120,16 +184,10 @@ Pair<FVec3, bool> FImplicitObject::FindDeepestIntersection(const FImplicitObject
 		TAABB<FReal, 3> ImplicitBox = BoundingBox().TransformedAABB(OtherToLocalTransform.Inverse());
 		ImplicitBox.Thicken(Thickness);
 		TArray<int32> PotentialParticles = Particles->FindAllIntersections(ImplicitBox);
-		for (int32 i : PotentialParticles)
+		DispatchOnConcreteType(*this, [&](const auto& Concrete)
 		{
-			FVec3 LocalPoint = OtherToLocalTransform.TransformPosition(Particles->X(i));
-			FReal LocalPhi = SignedDistance(LocalPoint);
-			if (LocalPhi < Phi)
-			{
-				Phi = LocalPhi;
-				Point = Particles->X(i);
-			}
-		}
+			FindDeepestParticle(Concrete, *Particles, OtherToLocalTransform, PotentialParticles.Num(), [&PotentialParticles](const int32 Candidate) { return PotentialParticles[Candidate]; }, Phi, Point);
+		});
 	}
 	else
 	{
@@ -149,16 +207,10 @@ Pair<FVec3, bool> FImplicitObject::FindDeepestIntersection(const FImplicitObject
 	FVec3 Point;
 	FReal Phi = Thickness;
 	int32 NumParticles = Particles->Size();
-	for (int32 i = 0; i < NumParticles; ++i)
+	DispatchOnConcreteType(*this, [&](const auto& Concrete)
 	{
-		FVec3 LocalPoint = OtherToLocalTransform.TransformPosition(Particles->X(i));
-		FReal LocalPhi = SignedDistance(LocalPoint);
-		if (LocalPhi < Phi)
-		{
-			Phi = LocalPhi;
-			Point = Particles->X(i);
-		}
-	}
+		FindDeepestParticle(Concrete, *Particles, OtherToLocalTransform, NumParticles, [](const int32 Candidate) { return Candidate; }, Phi, Point);
+	});
 	return MakePair(Point, Phi < Thickness);
 }
 
@@ -214,7 +266,9 @@ Pair<FVec3, bool> FImplicitObject::FindClosestIntersection(const FVec3& StartPoi
 float ClosestIntersectionStepSizeMultiplier = 0.5f;
 FAutoConsoleVariableRef CVarClosestIntersectionStepSizeMultiplier(TEXT("p.ClosestIntersectionStepSizeMultiplier"), ClosestIntersectionStepSizeMultiplier, TEXT("When raycasting we use this multiplier to substep the travel distance along the ray. Smaller number gives better accuracy at higher cost"));
 
-Pair<FVec3, bool> FImplicitObject::FindClosestIntersectionImp(const FVec3& StartPoint, const FVec3& EndPoint, const FReal Thickness) const
+// Sphere marching toward EndPoint, shared by every type that doesn't provide an analytic FindClosestIntersectionImp
+template <typename TConcrete>
+static Pair<FVec3, bool> FindClosestIntersectionMarching(const TConcrete& Object, const FVec3& StartPoint, const FVec3& EndPoint, const FReal Thickness)
 {
 	FReal Epsilon = (FReal)1e-4;
 
@@ -222,11 +276,11 @@ Pair<FVec3, bool> FImplicitObject::FindClosestIntersectionImp(const FVec3& Start
 	FReal Length = Ray.Size();
 	FVec3 Direction = Ray.GetUnsafeNormal(); //this is safe because StartPoint and EndPoint were already tested to be far enough away. In the case where ModifiedEnd is pushed, we push it along the direction so it can only get farther
 	FVec3 EndNormal;
-	const FReal EndPhi = PhiWithNormal(EndPoint, EndNormal);
+	const FReal EndPhi = DirectPhiWithNormal(Object, EndPoint, EndNormal);
 	FVec3 ClosestPoint = StartPoint;
 
 	FVec3 Normal;
-	FReal Phi = PhiWithNormal(ClosestPoint, Normal);
+	FReal Phi = DirectPhiWithNormal(Object, ClosestPoint, Normal);
 
 	while (Phi > Thickness + Epsilon)
 	{
@@ -255,7 +309,7 @@ Pair<FVec3, bool> FImplicitObject::FindClosestIntersectionImp(const FVec3& Start
 				}
 			}
 		}
-		FReal NewPhi = PhiWithNormal(ClosestPoint, Normal);
+		FReal NewPhi = DirectPhiWithNormal(Object, ClosestPoint, Normal);
 		if (NewPhi >= Phi)
 		{
 			if (EndPhi < Thickness + Epsilon)
@@ -273,6 +327,16 @@ Pair<FVec3, bool> FImplicitObject::FindClosestIntersectionImp(const FVec3& Start
 	return MakePair(ClosestPoint, true);
 }
 
+Pair<FVec3, bool> FImplicitObject::FindClosestIntersectionImp(const FVec3& StartPoint, const FVec3& EndPoint, const FReal Thickness) const
+{
+	Pair<FVec3, bool> Result;
+	DispatchOnConcreteType(*this, [&](const auto& Concrete)
+	{
+		Result = FindClosestIntersectionMarching(Concrete, StartPoint, EndPoint, Thickness);
+	});
+	return Result;
+}
+
 void FImplicitObject::FindAllIntersectingObjects(TArray<Pair<const FImplicitObject*, FRigidTransform3>>& Out, const TAABB<FReal, 3>& LocalBounds) const
 {
 	if (!HasBoundingBox() || LocalBounds.Intersects(BoundingBox()))
@@ -9,6 +9,23 @@ struct FLargeImplicitObjectUnionData
 	TGeometryParticles<FReal,3> GeomParticles;
 	TBoundingVolumeHierarchy<TGeometryParticles<FReal,3>, TArray<int32>, FReal, 3> Hierarchy;
 
+	// Flattened hierarchy used for queries. The serialized Hierarchy above is kept for the archive format,
+	// this one is rebuilt from GeomParticles whenever the data is created or loaded.
+	struct FFlatNode
+	{
+		TAABB<FReal, 3> Bounds;
+		// Leaf: first entry in FlatChildren. Internal: index of the second child, the first child is the next node.
+		int32 First;
+		// Number of children in a leaf, 0 for internal nodes
+		int32 Count;
+	};
+
+	TArray<FFlatNode> FlatNodes;
+	TArray<int32> FlatChildren;
+	TArray<TAABB<FReal, 3>> ChildBounds;
+	TArray<FRigidTransform3> ChildTransforms;
+	TArray<int32> UnboundedChildren;
+
 	FLargeImplicitObjectUnionData(const TArray<Pair<TSerializablePtr<FImplicitObject>,FRigidTransform3>>& SubObjects)
 	{
 		const int32 NumObjects = SubObjects.Num();
@@ -22,15 +39,145 @@ struct FLargeImplicitObjectUnionData
 		}
 
 		Hierarchy = TBoundingVolumeHierarchy<TGeometryParticles<FReal,3>,TArray<int32>,FReal,3> (GeomParticles,1);
+		BuildFlatHierarchy();
 	}
 
 	void Serialize(FChaosArchive& Ar)
 	{
 		Ar << GeomParticles << Hierarchy;
+		if (Ar.IsLoading())
+		{
+			BuildFlatHierarchy();
+		}
+	}
+
+	// Calls Visitor(ChildIndex) for every child whose bounds overlap LocalBounds, in ascending child order.
+	// Children without bounds always overlap.
+	template <typename FVisitor>
+	void VisitIntersectingChildren(const TAABB<FReal, 3>& LocalBounds, const FVisitor& Visitor) const
+	{
+		TArray<int32, TInlineAllocator<64>> Hits;
+		Hits.Append(UnboundedChildren);
+
+		if (FlatNodes.Num())
+		{
+			TArray<int32, TInlineAllocator<32>> NodeStack;
+			NodeStack.Add(0);
+			while (NodeStack.Num())
+			{
+				const int32 NodeIndex = NodeStack.Pop(false);
+				const FFlatNode& Node = FlatNodes[NodeIndex];
+				if (!Node.Bounds.Intersects(LocalBounds))
+				{
+					continue;
+				}
+
+				if (Node.Count > 0)
+				{
+					for (int32 Entry = Node.First; Entry < Node.First + Node.Count; ++Entry)
+					{
+						const int32 ChildIndex = FlatChildren[Entry];
+						if (ChildBounds[ChildIndex].Intersects(LocalBounds))
+						{
+							Hits.Add(ChildIndex);
+						}
+					}
+				}
+				else
+				{
+					NodeStack.Add(Node.First);
+					NodeStack.Add(NodeIndex + 1);
+				}
+			}
+		}
+
+		// Every child lives in exactly one leaf, so sorting is enough to match the hierarchy's ordering
+		Hits.Sort();
+		for (const int32 ChildIndex : Hits)
+		{
+			Visitor(ChildIndex);
+		}
 	}
 
 	FLargeImplicitObjectUnionData(){}
 
+private:
+
+	static constexpr int32 MaxChildrenPerFlatLeaf = 4;
+
+	void BuildFlatHierarchy()
+	{
+		const int32 NumObjects = (int32)GeomParticles.Size();
+		FlatNodes.Reset();
+		FlatChildren.Reset();
+		UnboundedChildren.Reset();
+		ChildBounds.SetNum(NumObjects);
+		ChildTransforms.SetNum(NumObjects);
+
+		FlatChildren.Reserve(NumObjects);
+		for (int32 i = 0; i < NumObjects; ++i)
+		{
+			ChildTransforms[i] = FRigidTransform3(GeomParticles.X(i), GeomParticles.R(i));
+			const FImplicitObject* Geometry = GeomParticles.Geometry(i).Get();
+			if (Geometry && Geometry->HasBoundingBox())
+			{
+				ChildBounds[i] = Geometry->BoundingBox().TransformedAABB(ChildTransforms[i]);
+				FlatChildren.Add(i);
+			}
+			else
+			{
+				// Never tested, unbounded children are always reported
+				ChildBounds[i] = TAABB<FReal, 3>::EmptyAABB();
+				UnboundedChildren.Add(i);
+			}
+		}
+
+		if (FlatChildren.Num())
+		{
+			// Roughly two nodes per leaf
+			FlatNodes.Reserve(2 * FMath::DivideAndRoundUp(FlatChildren.Num(), MaxChildrenPerFlatLeaf));
+			BuildFlatNode(0, FlatChildren.Num());
+		}
+	}
+
+	// Median split along the longest axis of the child centers, nodes are laid out depth first
+	void BuildFlatNode(const int32 Begin, const int32 End)
+	{
+		const int32 NodeIndex = FlatNodes.AddUninitialized();
+		TAABB<FReal, 3> Bounds = ChildBounds[FlatChildren[Begin]];
+		TAABB<FReal, 3> CenterBounds(Bounds.Center(), Bounds.Center());
+		for (int32 Entry = Begin + 1; Entry < End; ++Entry)
+		{
+			const TAABB<FReal, 3>& Box = ChildBounds[FlatChildren[Entry]];
+			Bounds.GrowToInclude(Box);
+			CenterBounds.GrowToInclude(Box.Center());
+		}
+		FlatNodes[NodeIndex].Bounds = Bounds;
+
+		const int32 Num = End - Begin;
+		if (Num <= MaxChildrenPerFlatLeaf)
+		{
+			FlatNodes[NodeIndex].First = Begin;
+			FlatNodes[NodeIndex].Count = Num;
+			return;
+		}
+
+		const int32 Axis = CenterBounds.LargestAxis();
+		const TArray<TAABB<FReal, 3>>& Boxes = ChildBounds;
+		Sort(FlatChildren.GetData() + Begin, Num, [&Boxes, Axis](const int32 A, const int32 B)
+		{
+			return Boxes[A].Center()[Axis] < Boxes[B].Center()[Axis];
+		});
+
+		const int32 Mid = Begin + Num / 2;
+		BuildFlatNode(Begin, Mid);
+		FlatNodes[NodeIndex].First = FlatNodes.Num();
+		FlatNodes[NodeIndex].Count = 0;
+		BuildFlatNode(Mid, End);
+	}
+
+public:
+
 	FLargeImplicitObjectUnionData(const FLargeImplicitObjectUnionData& Other) = delete;
 	FLargeImplicitObjectUnionData& operator=(const FLargeImplicitObjectUnionData& Other) = delete;
 };
@@ -78,13 +225,11 @@ void FImplicitObjectUnion::FindAllIntersectingObjects(TArray < Pair<const FImpli
 {
 	if (LargeUnionData)
 	{
-		TArray<int32> Overlaps = LargeUnionData->Hierarchy.FindAllIntersections(LocalBounds);
-		Out.Reserve(Out.Num() + Overlaps.Num());
-		for (int32 Idx : Overlaps)
+		const FLargeImplicitObjectUnionData& Data = *LargeUnionData;
+		Data.VisitIntersectingChildren(LocalBounds, [&Out, &Data](const int32 Idx)
 		{
-			const FImplicitObject* Obj = LargeUnionData->GeomParticles.Geometry(Idx).Get();
-			Out.Add(MakePair(Obj,FRigidTransform3(LargeUnionData->GeomParticles.X(Idx), LargeUnionData->GeomParticles.R(Idx))));
-		}
+			Out.Emplace(MakePair(Data.GeomParticles.Geometry(Idx).Get(), Data.ChildTransforms[Idx]));
+		});
 	}
 	else
 	{
@@ -188,15 +333,13 @@ FImplicitObjectUnionClustered::FindAllIntersectingChildren(const TAABB<FReal, 3>
 	TArray<TPBDRigidParticleHandle<FReal, 3>*> IntersectingChildren;
 	if (LargeUnionData) //todo: make this work when hierarchy is not built
 	{
-		TArray<int32> IntersectingIndices = LargeUnionData->Hierarchy.FindAllIntersections(LocalBounds);
-		IntersectingChildren.Reserve(IntersectingIndices.Num());
-		for (const int32 Idx : IntersectingIndices)
+		LargeUnionData->VisitIntersectingChildren(LocalBounds, [this, &IntersectingChildren](const int32 Idx)
 		{
 			if (MOriginalParticleLookupHack.IsValidIndex(Idx))
 			{
 				IntersectingChildren.Add(MOriginalParticleLookupHack[Idx]);
 			}
-		}
+		});
 	}
 	else
 	{
@@ -4,6 +4,7 @@
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
 
 #include <algorithm>
 #include <vector>
@@ -37,6 +38,9 @@ FAutoConsoleVariableRef CVarNumOverlapSphereSamples(TEXT("p.LevelsetOverlapSpher
 int32 NumOverlapCapsuleSamples = 24;
 FAutoConsoleVariableRef CVarNumOverlapCapsuleSamples(TEXT("p.LevelsetOverlapCapsuleSamples"), NumOverlapCapsuleSamples, TEXT("Number of spiral points to generate for levelset-capsule overlaps"));
 
+int32 LevelSetStoreNormals = 1;
+FAutoConsoleVariableRef CVarLevelSetStoreNormals(TEXT("p.LevelSetStoreNormals"), LevelSetStoreNormals, TEXT("Whether new level sets keep their per-cell normal grid. If 0 the grid is freed after construction and PhiWithNormal takes the normal from the phi gradient, cutting level set memory to a quarter"));
+
 using namespace Chaos;
 
 #define MAX_CLAMP(a, comp, b) (a >= comp ? b : a)
@@ -101,6 +105,11 @@ TLevelSet<T, d>::TLevelSet(FErrorReporter& ErrorReporter, const TUniformGrid<T,
 
 	// Check newly created level set values for inf/nan
 	bool ValidLevelSet = CheckData(ErrorReporter, InParticles, Mesh, Normals);
+
+	if (!LevelSetStoreNormals)
+	{
+		MNormals.Copy(TArrayND<TVector<T, d>, d>());
+	}
 }
 
 template<class T, int d>
@@ -118,18 +127,22 @@ TLevelSet<T, d>::TLevelSet(FErrorReporter& ErrorReporter, const TUniformGrid<T,
 	const auto& Counts = MGrid.Counts();
 	if (bUseObjectPhi)
 	{
-		for (int32 i = 0; i < Counts.Product(); ++i)
+		ParallelFor(Counts.Product(), [&](int32 i)
 		{
 			MPhi[i] = InObject.SignedDistance(MGrid.Center(i));
-		}
+		});
 		ComputeNormals();
+		if (!LevelSetStoreNormals)
+		{
+			MNormals.Copy(TArrayND<TVector<T, d>, d>());
+		}
 		return;
 	}
 	TArrayND<T, d> ObjectPhi(MGrid);
-	for (int32 i = 0; i < Counts.Product(); ++i)
+	ParallelFor(Counts.Product(), [&](int32 i)
 	{
 		ObjectPhi[i] = InObject.SignedDistance(MGrid.Center(i));
-	}
+	});
 	TArray<TVector<int32, d>> InterfaceIndices;
 	ComputeDistancesNearZeroIsocontour(InObject, ObjectPhi, InterfaceIndices);
 	T StoppingDistance = MBandWidth * MGrid.Dx().Max();
@@ -158,6 +171,10 @@ TLevelSet<T, d>::TLevelSet(FErrorReporter& ErrorReporter, const TUniformGrid<T,
 	}
 	ComputeNormals();
 	ComputeConvexity(InterfaceIndices);
+	if (!LevelSetStoreNormals)
+	{
+		MNormals.Copy(TArrayND<TVector<T, d>, d>());
+	}
 }
 
 template<class T, int d>
@@ -997,57 +1014,72 @@ bool Compare(const Pair<T*, TVector<int32, d>>& Other1, const Pair<T*, TVector<i
 	return FMath::Abs(*Other1.First) < FMath::Abs(*Other2.First);
 }
 
+// Fast marching heap entry. The key is a copy of |phi| when the entry was pushed, so updating a cell
+// pushes a new entry instead of invalidating the heap, and stale entries are skipped when popped.
+template<class T, int d>
+struct TFastMarchingEntry
+{
+	T AbsPhi;
+	TVector<int32, d> CellIndex;
+};
+
 template<class T, int d>
 void TLevelSet<T, d>::FillWithFastMarchingMethod(const T StoppingDistance, const TArray<TVector<int32, d>>& InterfaceIndices)
 {
-	TArrayND<bool, d> Done(MGrid), InHeap(MGrid);
+	TArrayND<bool, d> Done(MGrid), Popped(MGrid);
 	Done.Fill(false);
-	InHeap.Fill(false);
-	TArray<Pair<T*, TVector<int32, d>>> Heap;
+	Popped.Fill(false);
+
+	const auto HeapPredicate = [](const TFastMarchingEntry<T, d>& Entry1, const TFastMarchingEntry<T, d>& Entry2)
+	{
+		return Entry1.AbsPhi < Entry2.AbsPhi;
+	};
+
+	TArray<TFastMarchingEntry<T, d>> Heap;
+	Heap.Reserve(InterfaceIndices.Num() * 2);
 	// TODO(mlentine): Update phi for these cells
 	for (const auto& CellIndex : InterfaceIndices)
 	{
-		check(!Done(CellIndex) && !InHeap(CellIndex));
+		check(!Done(CellIndex));
 		Done(CellIndex) = true;
-		Heap.Add(MakePair(&MPhi(CellIndex), CellIndex));
-		InHeap(CellIndex) = true;
+		Heap.Add({ FMath::Abs(MPhi(CellIndex)), CellIndex });
 	}
-	Heap.Heapify(Compare<T, d>);
+	Heap.Heapify(HeapPredicate);
+
+	const auto UpdateNeighbor = [&](const TVector<int32, d>& CellIndex)
+	{
+		MPhi(CellIndex) = ComputePhi(Done, CellIndex);
+		Heap.HeapPush({ FMath::Abs(MPhi(CellIndex)), CellIndex }, HeapPredicate);
+	};
+
 	while (Heap.Num())
 	{
-		Pair<T*, TVector<int32, d>> Smallest;
-		Heap.HeapPop(Smallest, Compare<T, d>);
-		check(InHeap(Smallest.Second));
-		if (StoppingDistance && FGenericPlatformMath::Abs(*Smallest.First) > StoppingDistance)
+		TFastMarchingEntry<T, d> Smallest;
+		Heap.HeapPop(Smallest, HeapPredicate, /*bAllowShrinking=*/false);
+		if (Popped(Smallest.CellIndex) || Smallest.AbsPhi != FMath::Abs(MPhi(Smallest.CellIndex)))
+		{
+			// Already processed, or phi changed after this entry was pushed
+			continue;
+		}
+		if (StoppingDistance && Smallest.AbsPhi > StoppingDistance)
 		{
 			break;
 		}
-		Done(Smallest.Second) = true;
-		InHeap(Smallest.Second) = false;
+		Popped(Smallest.CellIndex) = true;
+		Done(Smallest.CellIndex) = true;
 		for (int32 Axis = 0; Axis < d; ++Axis)
 		{
-			const auto IP1 = Smallest.Second + TVector<int32, d>::AxisVector(Axis);
-			const auto IM1 = Smallest.Second - TVector<int32, d>::AxisVector(Axis);
+			const auto IP1 = Smallest.CellIndex + TVector<int32, d>::AxisVector(Axis);
+			const auto IM1 = Smallest.CellIndex - TVector<int32, d>::AxisVector(Axis);
 			if (IM1[Axis] >= 0 && !Done(IM1))
 			{
-				MPhi(IM1) = ComputePhi(Done, IM1);
-				if (!InHeap(IM1))
-				{
-					Heap.Add(MakePair(&MPhi(IM1), IM1));
-					InHeap(IM1) = true;
-				}
+				UpdateNeighbor(IM1);
 			}
 			if (IP1[Axis] < MGrid.Counts()[Axis] && !Done(IP1))
 			{
-				MPhi(IP1) = ComputePhi(Done, IP1);
-				if (!InHeap(IP1))
-				{
-					Heap.Add(MakePair(&MPhi(IP1), IP1));
-					InHeap(IP1) = true;
-				}
+				UpdateNeighbor(IP1);
 			}
 		}
-		Heap.Heapify(Compare<T, d>);
 	}
 }
 
@@ -1242,14 +1274,15 @@ template<class T, int d>
 void TLevelSet<T, d>::ComputeNormals()
 {
 	const auto& Counts = MGrid.Counts();
-	for (int32 i = 0; i < Counts[0]; ++i)
+	const auto Dx = MGrid.Dx();
+	// Every cell only reads phi and writes its own normal, so slices along X are independent
+	ParallelFor(Counts[0], [&](int32 i)
 	{
 		for (int32 j = 0; j < Counts[1]; ++j)
 		{
 			for (int32 k = 0; k < Counts[2]; ++k)
 			{
 				const TVector<int32, d> CellIndex(i, j, k);
-				const auto Dx = MGrid.Dx();
 				TVector<T, d> X = MGrid.Location(CellIndex);
 				MNormals(CellIndex) = TVector<T, d>(
 				    (SignedDistance(X + TVector<T, d>::AxisVector(0) * Dx[0]) - SignedDistance(X - TVector<T, d>::AxisVector(0) * Dx[0])) / (2 * Dx[0]),
@@ -1267,7 +1300,7 @@ void TLevelSet<T, d>::ComputeNormals()
 				}
 			}
 		}
-	}
+	});
 }
 
 // @todo(mlentine): This is super expensive but until we know it is working it's better to keep it outside of main level set generation
@@ -1420,7 +1453,31 @@ T TLevelSet<T, d>::PhiWithNormal(const TVector<T, d>& x, TVector<T, d>& Normal)
 	}
 	else
 	{
-		Normal = MGrid.LinearlyInterpolate(MNormals, Location);
+		if (MNormals.Num())
+		{
+			Normal = MGrid.LinearlyInterpolate(MNormals, Location);
+		}
+		else
+		{
+			// No stored normals (p.LevelSetStoreNormals), so difference phi half a cell either side of the sample.
+			// Near the border the clamp shortens the step, so divide by the distance actually sampled.
+			const TVector<T, d> Dx = MGrid.Dx();
+			for (int32 Axis = 0; Axis < d; ++Axis)
+			{
+				const TVector<T, d> Offset = TVector<T, d>::AxisVector(Axis) * (Dx[Axis] * (T)0.5);
+				const TVector<T, d> Plus = MGrid.ClampMinusHalf(Location + Offset);
+				const TVector<T, d> Minus = MGrid.ClampMinusHalf(Location - Offset);
+				const T Distance = Plus[Axis] - Minus[Axis];
+				if (Distance > SMALL_NUMBER)
+				{
+					Normal[Axis] = (MGrid.LinearlyInterpolate(MPhi, Plus) - MGrid.LinearlyInterpolate(MPhi, Minus)) / Distance;
+				}
+				else
+				{
+					Normal[Axis] = (T)0;
+				}
+			}
+		}
 		T NormalMag = Normal.Size();
 		if (NormalMag > SMALL_NUMBER)
 		{
@@ -1436,7 +1493,8 @@ T TLevelSet<T, d>::PhiWithNormal(const TVector<T, d>& x, TVector<T, d>& Normal)
 	return SizeSquared ? (sqrt(SizeSquared) + Phi) : Phi;
 }
 
-void GetGeomSurfaceSamples(const TSphere<FReal, 3>& InGeom, TArray<FVec3>& OutSamples)
+template <typename AllocatorType>
+void GetGeomSurfaceSamples(const TSphere<FReal, 3>& InGeom, TArray<FVec3, AllocatorType>& OutSamples)
 {
 	OutSamples.Reset();
 	OutSamples.AddUninitialized(6);
@@ -1451,7 +1509,8 @@ void GetGeomSurfaceSamples(const TSphere<FReal, 3>& InGeom, TArray<FVec3>& OutSa
 	OutSamples[5] = FVec3(0, Radius, -Radius);
 }
 
-void GetGeomSurfaceSamples(const TBox<FReal, 3>& InGeom, TArray<FVec3>& OutSamples)
+template <typename AllocatorType>
+void GetGeomSurfaceSamples(const TBox<FReal, 3>& InGeom, TArray<FVec3, AllocatorType>& OutSamples)
 {
 	OutSamples.Reset();
 	OutSamples.AddUninitialized(8);
@@ -1469,7 +1528,8 @@ void GetGeomSurfaceSamples(const TBox<FReal, 3>& InGeom, TArray<FVec3>& OutSampl
 	OutSamples[7] = FVec3(Min.X, Max.Y, Max.Z);
 }
 
-void GetGeomSurfaceSamples(const TCapsule<FReal>& InGeom, TArray<FVec3>& OutSamples)
+template <typename AllocatorType>
+void GetGeomSurfaceSamples(const TCapsule<FReal>& InGeom, TArray<FVec3, AllocatorType>& OutSamples)
 {
 	OutSamples.Reset();
 	OutSamples.AddUninitialized(14);
@@ -1493,7 +1553,8 @@ void GetGeomSurfaceSamples(const TCapsule<FReal>& InGeom, TArray<FVec3>& OutSamp
 	OutSamples[13]	= FVec3(-HalfHeight, Radius, -Radius);
 }
 
-void GetGeomSurfaceSamples(const FConvex& InGeom, TArray<FVec3>& OutSamples)
+template <typename AllocatorType>
+void GetGeomSurfaceSamples(const FConvex& InGeom, TArray<FVec3, AllocatorType>& OutSamples)
 {
 	const TParticles<FReal, 3>& Particles = InGeom.GetSurfaceParticles();
 
@@ -1508,8 +1569,8 @@ void GetGeomSurfaceSamples(const FConvex& InGeom, TArray<FVec3>& OutSamples)
 	}
 }
 
-template<typename InnerT>
-void GetGeomSurfaceSamples(const TImplicitObjectScaled<InnerT>& InScaledGeom, TArray<FVec3>& OutSamples)
+template<typename InnerT, typename AllocatorType>
+void GetGeomSurfaceSamples(const TImplicitObjectScaled<InnerT>& InScaledGeom, TArray<FVec3, AllocatorType>& OutSamples)
 {
 	const InnerT* InnerObject = InScaledGeom.Object().Get();
 
@@ -1531,7 +1592,9 @@ template <typename QueryGeomType>
 bool TLevelSet<T, d>::SweepGeomImp(const QueryGeomType& QueryGeom, const FRigidTransform3& StartTM, const FVec3& Dir, const FReal Length,
 	FReal& OutTime, FVec3& OutPosition, FVec3& OutNormal, int32& OutFaceIndex, const FReal Thickness, const bool bComputeMTD) const
 {
-	TArray<FVec3> Samples;
+	// Per-query scratch comes from the thread's mem stack rather than the shared heap
+	FMemMark Mark(FMemStack::Get());
+	TArray<FVec3, TMemStackAllocator<>> Samples;
 	GetGeomSurfaceSamples(QueryGeom, Samples);
 
 	OutTime = TNumericLimits<FReal>::Max();
@@ -17,6 +17,7 @@
 #include "Chaos/Levelset.h"
 #include "Chaos/Pair.h"
 #include "Chaos/PBDCollisionConstraintsContact.h"
+#include "Chaos/PBDCollisionConstraintsContactBatch.h"
 #include "Chaos/PBDRigidsSOAs.h"
 #include "Chaos/Sphere.h"
 #include "Chaos/Transform.h"
@@ -62,6 +63,15 @@ namespace Chaos
 	int32 Chaos_Collision_UseAccumulatedImpulseClipSolve = 0; // Experimental: This requires multiple contact points per iteration per pair, and making sure the contact points don't move too much in body space
 	FAutoConsoleVariableRef CVarChaosCollisionOriginalSolve(TEXT("p.Chaos.Collision.UseAccumulatedImpulseClipSolve"), Chaos_Collision_UseAccumulatedImpulseClipSolve, TEXT("Use experimental Accumulated impulse clipped contact solve"));
 
+	int32 Chaos_Collision_BatchApply = 1;
+	FAutoConsoleVariableRef CVarChaosCollisionBatchApply(TEXT("p.Chaos.Collision.BatchApply"), Chaos_Collision_BatchApply, TEXT("Solve independent contacts (e.g., a constraint color) in structure-of-arrays batches in the velocity Apply step"));
+
+	int32 Chaos_Collision_BatchApplySize = 128;
+	FAutoConsoleVariableRef CVarChaosCollisionBatchApplySize(TEXT("p.Chaos.Collision.BatchApplySize"), Chaos_Collision_BatchApplySize, TEXT("Number of contacts per parallel task when p.Chaos.Collision.BatchApply is enabled"));
+
+	int32 Chaos_Collision_ParallelUpdate = 1;
+	FAutoConsoleVariableRef CVarChaosCollisionParallelUpdate(TEXT("p.Chaos.Collision.ParallelUpdate"), Chaos_Collision_ParallelUpdate, TEXT("Run the per-tick contact and manifold updates in parallel"));
+
 	DECLARE_CYCLE_STAT(TEXT("Collisions::Reset"), STAT_Collisions_Reset, STATGROUP_ChaosCollision);
 	DECLARE_CYCLE_STAT(TEXT("Collisions::UpdatePointConstraints"), STAT_Collisions_UpdatePointConstraints, STATGROUP_ChaosCollision);
 	DECLARE_CYCLE_STAT(TEXT("Collisions::UpdateManifoldConstraints"), STAT_Collisions_UpdateManifoldConstraints, STATGROUP_ChaosCollision);
@@ -132,11 +142,12 @@ namespace Chaos
 	template<typename T, int d>
 	void TPBDCollisionConstraints<T, d>::UpdateConstraintMaterialProperties(FConstraintBase& Constraint)
 	{
-		TSerializablePtr<FChaosPhysicsMaterial> PhysicsMaterial0 = Constraint.Particle[0]->AuxilaryValue(MPhysicsMaterials);
-		TSerializablePtr<FChaosPhysicsMaterial> PhysicsMaterial1 = Constraint.Particle[1]->AuxilaryValue(MPhysicsMaterials);
+		// The combined values are cached on the contact here so the solver iterations never touch the materials
+		const FChaosPhysicsMaterial* PhysicsMaterial0 = Constraint.Particle[0]->AuxilaryValue(MPhysicsMaterials).Get();
+		const FChaosPhysicsMaterial* PhysicsMaterial1 = Constraint.Particle[1]->AuxilaryValue(MPhysicsMaterials).Get();
 
 		TCollisionContact<T, d>& Contact = Constraint.Manifold;
-		if (PhysicsMaterial0 && PhysicsMaterial1)
+		if (PhysicsMaterial0 && PhysicsMaterial1 && PhysicsMaterial0 != PhysicsMaterial1)
 		{
 			// @todo(ccaulfield): support different friction/restitution combining algorithms
 			Contact.Restitution = FMath::Min(PhysicsMaterial0->Restitution, PhysicsMaterial1->Restitution);
@@ -423,28 +434,19 @@ namespace Chaos
 			MCullDistance = MinCullDistanceForImpulseClipping;
 		}
 
-		// @todo(chaos): parallelism needs to be optional
-
-		//PhysicsParallelFor(Handles.Num(), [&](int32 ConstraintHandleIndex)
-		//{
-		//	FConstraintContainerHandle* ConstraintHandle = Handles[ConstraintHandleIndex];
-		//	check(ConstraintHandle != nullptr);
-		//	Collisions::Update(MCullDistance, MShapePadding, ConstraintHandle->GetContact());
-
-		//	if (ConstraintHandle->GetContact().GetPhi() < MCullDistance) 
-		//	{
-		//		ConstraintHandle->GetContact().Timestamp = LifespanCounter;
-		//	}
-		//}, bDisableCollisionParallelFor);
-
-		for (FPointContactConstraint& Contact : PointConstraints)
+		// Each update only reads particle transforms and writes to its own constraint, so the result does not depend on the
+		// order (or thread) in which constraints are processed
+		const T CullDistance = MCullDistance;
+		const int32 Timestamp = LifespanCounter;
+		PhysicsParallelFor(PointConstraints.Num(), [&](int32 ConstraintIndex)
 		{
-			Collisions::Update(Contact, MCullDistance);
-			if (Contact.GetPhi() < MCullDistance)
+			FPointContactConstraint& Contact = PointConstraints[ConstraintIndex];
+			Collisions::Update(Contact, CullDistance);
+			if (Contact.GetPhi() < CullDistance)
 			{
-				Contact.Timestamp = LifespanCounter;
+				Contact.Timestamp = Timestamp;
 			}
-		}
+		}, bDisableCollisionParallelFor || !Chaos_Collision_ParallelUpdate);
 	}
 
 	// Called once per tick to update/regenerate persistent manifold planes and points
@@ -453,25 +455,19 @@ namespace Chaos
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Collisions_UpdateManifoldConstraints);
 
-		// @todo(chaos): parallelism needs to be optional
-
-		//PhysicsParallelFor(Handles.Num(), [&](int32 ConstraintHandleIndex)
-		//{
-		//	FConstraintContainerHandle* ConstraintHandle = Handles[ConstraintHandleIndex];
-		//	check(ConstraintHandle != nullptr);
-		//	Collisions::Update(MCullDistance, MShapePadding, ConstraintHandle->GetContact());
-		//}, bDisableCollisionParallelFor);
-
+		// As in UpdateConstraints, each manifold update only writes to its own constraint. The context is read-only.
 		FCollisionContext Context;
-
-		for (FMultiPointContactConstraint& Contact : IterativeConstraints)
+		const T CullDistance = MCullDistance;
+		const int32 Timestamp = LifespanCounter;
+		PhysicsParallelFor(IterativeConstraints.Num(), [&](int32 ConstraintIndex)
 		{
-			Collisions::UpdateManifold(Contact, MCullDistance, Context);
-			if (Contact.GetPhi() < MCullDistance)
+			FMultiPointContactConstraint& Contact = IterativeConstraints[ConstraintIndex];
+			Collisions::UpdateManifold(Contact, CullDistance, Context);
+			if (Contact.GetPhi() < CullDistance)
 			{
-				Contact.Timestamp = LifespanCounter;
+				Contact.Timestamp = Timestamp;
 			}
-		}
+		}, bDisableCollisionParallelFor || !Chaos_Collision_ParallelUpdate);
 	}
 
 	template<typename T, int d>
@@ -553,7 +549,37 @@ namespace Chaos
 
 		TAtomic<bool> bNeedsAnotherIterationAtomic;
 		bNeedsAnotherIterationAtomic.Store(false);
-		if (MApplyPairIterations > 0)
+		if ((MApplyPairIterations > 0) && Chaos_Collision_BatchApply)
+		{
+			// The handles passed in here share no dynamic particles, so they can be gathered and solved together
+			const int32 BatchSize = FMath::Max(Chaos_Collision_BatchApplySize, 1);
+			const int32 NumBatches = (InConstraintHandles.Num() + BatchSize - 1) / BatchSize;
+			PhysicsParallelFor(NumBatches, [&](int32 BatchIndex) {
+				const int32 BatchStart = BatchIndex * BatchSize;
+				const int32 BatchEnd = FMath::Min(BatchStart + BatchSize, InConstraintHandles.Num());
+
+				TArray<FCollisionConstraintBase*, TInlineAllocator<128>> BatchConstraints;
+				BatchConstraints.Reserve(BatchEnd - BatchStart);
+				for (int32 ConstraintHandleIndex = BatchStart; ConstraintHandleIndex < BatchEnd; ++ConstraintHandleIndex)
+				{
+					FConstraintContainerHandle* ConstraintHandle = InConstraintHandles[ConstraintHandleIndex];
+					check(ConstraintHandle != nullptr);
+					BatchConstraints.Add(&ConstraintHandle->GetContact());
+				}
+
+				bool bNeedsAnotherIteration = false;
+				Collisions::TContactParticleParameters<T> ParticleParameters = { MCullDistance, MShapePadding, &MCollided };
+				Collisions::TContactIterationParameters<T> IterationParameters = { Dt, Iterations, NumIterations, MApplyPairIterations, ApplyType, &bNeedsAnotherIteration };
+				Collisions::ApplyBatch(BatchConstraints.GetData(), BatchConstraints.Num(), IterationParameters, ParticleParameters);
+
+				if (bNeedsAnotherIteration)
+				{
+					bNeedsAnotherIterationAtomic.Store(true);
+				}
+
+			}, bDisableCollisionParallelFor);
+		}
+		else if (MApplyPairIterations > 0)
 		{
 			PhysicsParallelFor(InConstraintHandles.Num(), [&](int32 ConstraintHandleIndex) {
 				FConstraintContainerHandle* ConstraintHandle = InConstraintHandles[ConstraintHandleIndex];
@@ -586,7 +612,8 @@ namespace Chaos
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Collisions_ApplyPushOut);
 
-		bool bNeedsAnotherIteration = false;
+		TAtomic<bool> bNeedsAnotherIterationAtomic;
+		bNeedsAnotherIterationAtomic.Store(false);
 		if (MApplyPushOutPairIterations > 0)
 		{
 			PhysicsParallelFor(InConstraintHandles.Num(), [&](int32 ConstraintHandleIndex)
@@ -594,13 +621,21 @@ namespace Chaos
 				FConstraintContainerHandle* ConstraintHandle = InConstraintHandles[ConstraintHandleIndex];
 				check(ConstraintHandle != nullptr);
 
+				bool bNeedsAnotherIterationLocal = false;
 				Collisions::TContactParticleParameters<T> ParticleParameters = { MCullDistance, MShapePadding, &MCollided };
-				Collisions::TContactIterationParameters<T> IterationParameters = { Dt, Iteration, NumIterations, MApplyPushOutPairIterations, ECollisionApplyType::None, &bNeedsAnotherIteration };
+				Collisions::TContactIterationParameters<T> IterationParameters = { Dt, Iteration, NumIterations, MApplyPushOutPairIterations, ECollisionApplyType::None, &bNeedsAnotherIterationLocal };
 				Collisions::ApplyPushOut(ConstraintHandle->GetContact(), IsTemporarilyStatic, IterationParameters, ParticleParameters);
 
+				if (bNeedsAnotherIterationLocal)
+				{
+					bNeedsAnotherIterationAtomic.Store(true);
+				}
+
 			}, bDisableCollisionParallelFor);
 		}
 
+		bool bNeedsAnotherIteration = bNeedsAnotherIterationAtomic.Load();
+
 		if (PostApplyPushOutCallback != nullptr)
 		{
 			PostApplyPushOutCallback(Dt, InConstraintHandles, bNeedsAnotherIteration);
@@ -1,12 +1,17 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Chaos/PBDCollisionConstraintsContact.h"
+#include "Chaos/PBDCollisionConstraintsContactBatch.h"
 #include "Chaos/CollisionResolution.h"
 #include "Chaos/CollisionResolutionUtil.h"
 #include "Chaos/Defines.h"
 #include "Chaos/Particle/ParticleUtilities.h"
 #include "Chaos/Utilities.h"
 
+#if INTEL_ISPC
+#include "PBDCollisionConstraints.ispc.generated.h"
+#endif
+
 //PRAGMA_DISABLE_OPTIMIZATION
 
 namespace Chaos
@@ -616,6 +621,274 @@ namespace Chaos
 			}
 		}
 
+		// Row layout of the structure-of-arrays contact batch. Must match the CONTACT_BATCH_ROW_* defines in PBDCollisionConstraints.ispc
+		enum EContactBatchRow
+		{
+			ContactBatchRow_RelativeVelocity = 0,	// 3 rows
+			ContactBatchRow_Normal = 3,				// 3 rows
+			ContactBatchRow_Factor = 6,				// 6 rows: 00, 01, 02, 11, 12, 22 of the symmetric contact mass matrix
+			ContactBatchRow_Friction = 12,
+			ContactBatchRow_Restitution = 13,
+			ContactBatchRow_Impulse = 14,			// 3 rows, output
+			ContactBatchRow_Num = 17
+		};
+
+		static const int32 ContactBatchNumLanes = 32;
+
+		// The per-contact state that the scatter pass needs in addition to the solved impulse
+		struct FContactBatchLane
+		{
+			FVec3* AccumulatedImpulse;
+			TPBDRigidParticleHandle<FReal, 3>* PBDRigid0;
+			TPBDRigidParticleHandle<FReal, 3>* PBDRigid1;
+			bool bIsRigidDynamic0;
+			bool bIsRigidDynamic1;
+			FVec3 P0;
+			FVec3 P1;
+			FRotation3 Q0;
+			FRotation3 Q1;
+			FVec3 VectorToPoint1;
+			FVec3 VectorToPoint2;
+			FVec3 Body1Velocity;
+			FVec3 Body2Velocity;
+			FMatrix33 WorldSpaceInvI1;
+			FMatrix33 WorldSpaceInvI2;
+		};
+
+		// Scalar version of the ISPC ApplyContactVelocityBatch kernel: the impulse part of ApplyContact for contacts without angular friction
+		static void ApplyContactVelocityBatchScalar(float* Data, const int32 Stride, const int32 NumContacts)
+		{
+			auto Row = [Data, Stride](const int32 RowIndex, const int32 Lane) -> float& { return Data[RowIndex * Stride + Lane]; };
+
+			for (int32 Lane = 0; Lane < NumContacts; ++Lane)
+			{
+				const FVec3 RelativeVelocity(Row(ContactBatchRow_RelativeVelocity, Lane), Row(ContactBatchRow_RelativeVelocity + 1, Lane), Row(ContactBatchRow_RelativeVelocity + 2, Lane));
+				const FVec3 Normal(Row(ContactBatchRow_Normal, Lane), Row(ContactBatchRow_Normal + 1, Lane), Row(ContactBatchRow_Normal + 2, Lane));
+				const FMatrix33 Factor(
+					Row(ContactBatchRow_Factor, Lane), Row(ContactBatchRow_Factor + 1, Lane), Row(ContactBatchRow_Factor + 2, Lane),
+					Row(ContactBatchRow_Factor + 3, Lane), Row(ContactBatchRow_Factor + 4, Lane), Row(ContactBatchRow_Factor + 5, Lane));
+				const FReal Friction = Row(ContactBatchRow_Friction, Lane);
+				const FReal Restitution = Row(ContactBatchRow_Restitution, Lane);
+				const FReal RelativeNormalVelocity = FVec3::DotProduct(RelativeVelocity, Normal);
+
+				FVec3 Impulse;
+				if (Friction > 0)
+				{
+					const FVec3 VelocityChange = -(Restitution * RelativeNormalVelocity * Normal + RelativeVelocity);
+					const FReal NormalVelocityChange = FVec3::DotProduct(VelocityChange, Normal);
+					const FReal TangentialSize = (VelocityChange - NormalVelocityChange * Normal).Size();
+					if (TangentialSize <= Friction * NormalVelocityChange)
+					{
+						const FMatrix33 FactorInverse = Factor.Inverse();
+						Impulse = FactorInverse * VelocityChange;
+					}
+					else
+					{
+						const FVec3 Tangent = (RelativeVelocity - RelativeNormalVelocity * Normal).GetSafeNormal();
+						const FVec3 Direction = Normal - Friction * Tangent;
+						FReal ImpulseDenominator = FVec3::DotProduct(Normal, Factor * Direction);
+						if (FMath::Abs(ImpulseDenominator) <= SMALL_NUMBER)
+						{
+							ImpulseDenominator = (FReal)1;
+						}
+						Impulse = (-(1 + Restitution) * RelativeNormalVelocity / ImpulseDenominator) * Direction;
+					}
+				}
+				else
+				{
+					FReal ImpulseDenominator = FVec3::DotProduct(Normal, Factor * Normal);
+					if (FMath::Abs(ImpulseDenominator) <= SMALL_NUMBER)
+					{
+						ImpulseDenominator = (FReal)1;
+					}
+					Impulse = (-(1 + Restitution) * RelativeNormalVelocity / ImpulseDenominator) * Normal;
+				}
+
+				Row(ContactBatchRow_Impulse, Lane) = Impulse.X;
+				Row(ContactBatchRow_Impulse + 1, Lane) = Impulse.Y;
+				Row(ContactBatchRow_Impulse + 2, Lane) = Impulse.Z;
+			}
+		}
+
+		// Gather one contact into the batch. Mirrors ApplyImpl and ApplyContact up to the impulse calculation for a single pair iteration.
+		// Returns false if the contact needs no impulse this iteration.
+		template<typename T_CONSTRAINT>
+		static bool GatherContactBatchLane(T_CONSTRAINT& Constraint, const FContactIterationParameters& IterationParameters, const FContactParticleParameters& ParticleParameters, FContactBatchLane& Lane, float* Data, const int32 LaneIndex)
+		{
+			// Collision is already up-to-date on first iteration (see ApplyImpl)
+			if (IterationParameters.Iteration > 0)
+			{
+				Collisions::Update(Constraint, ParticleParameters.CullDistance);
+			}
+
+			if (Constraint.GetPhi() >= ParticleParameters.ShapePadding)
+			{
+				return false;
+			}
+
+			TGenericParticleHandle<FReal, 3> Particle0 = TGenericParticleHandle<FReal, 3>(Constraint.Particle[0]);
+			TGenericParticleHandle<FReal, 3> Particle1 = TGenericParticleHandle<FReal, 3>(Constraint.Particle[1]);
+
+			if (ParticleParameters.Collided)
+			{
+				Particle0->AuxilaryValue(*ParticleParameters.Collided) = true;
+				Particle1->AuxilaryValue(*ParticleParameters.Collided) = true;
+			}
+
+			const FCollisionContact& Contact = Constraint.Manifold;
+			if (Contact.AngularFriction && (Contact.Friction > 0))
+			{
+				// Angular friction needs the full solve, which is not batched
+				Constraint.AccumulatedImpulse += ApplyContact(Constraint.Manifold, Particle0, Particle1, IterationParameters, ParticleParameters);
+				return false;
+			}
+
+			Lane.AccumulatedImpulse = &Constraint.AccumulatedImpulse;
+			Lane.PBDRigid0 = Particle0->CastToRigidParticle();
+			Lane.PBDRigid1 = Particle1->CastToRigidParticle();
+			Lane.bIsRigidDynamic0 = Lane.PBDRigid0 && Lane.PBDRigid0->ObjectState() == EObjectStateType::Dynamic;
+			Lane.bIsRigidDynamic1 = Lane.PBDRigid1 && Lane.PBDRigid1->ObjectState() == EObjectStateType::Dynamic;
+			Lane.P0 = FParticleUtilities::GetCoMWorldPosition(Particle0);
+			Lane.P1 = FParticleUtilities::GetCoMWorldPosition(Particle1);
+			Lane.Q0 = FParticleUtilities::GetCoMWorldRotation(Particle0);
+			Lane.Q1 = FParticleUtilities::GetCoMWorldRotation(Particle1);
+			Lane.VectorToPoint1 = Contact.Location - Lane.P0;
+			Lane.VectorToPoint2 = Contact.Location - Lane.P1;
+			Lane.Body1Velocity = FParticleUtilities::GetVelocityAtCoMRelativePosition(Particle0, Lane.VectorToPoint1);
+			Lane.Body2Velocity = FParticleUtilities::GetVelocityAtCoMRelativePosition(Particle1, Lane.VectorToPoint2);
+
+			const FVec3 RelativeVelocity = Lane.Body1Velocity - Lane.Body2Velocity;
+			if (FVec3::DotProduct(RelativeVelocity, Contact.Normal) >= 0) // ignore separating constraints
+			{
+				return false;
+			}
+			*IterationParameters.NeedsAnotherIteration = true;
+
+			Lane.WorldSpaceInvI1 = Lane.bIsRigidDynamic0 ? Utilities::ComputeWorldSpaceInertia(Lane.Q0, Lane.PBDRigid0->InvI()) : FMatrix33(0);
+			Lane.WorldSpaceInvI2 = Lane.bIsRigidDynamic1 ? Utilities::ComputeWorldSpaceInertia(Lane.Q1, Lane.PBDRigid1->InvI()) : FMatrix33(0);
+			const FMatrix33 Factor =
+				(Lane.bIsRigidDynamic0 ? ComputeFactorMatrix3(Lane.VectorToPoint1, Lane.WorldSpaceInvI1, Lane.PBDRigid0->InvM()) : FMatrix33(0)) +
+				(Lane.bIsRigidDynamic1 ? ComputeFactorMatrix3(Lane.VectorToPoint2, Lane.WorldSpaceInvI2, Lane.PBDRigid1->InvM()) : FMatrix33(0));
+
+			// Resting contact if very close to the surface
+			const bool bApplyRestitution = (RelativeVelocity.Size() > (2 * 980 * IterationParameters.Dt));
+
+			auto Row = [Data, LaneIndex](const int32 RowIndex) -> float& { return Data[RowIndex * ContactBatchNumLanes + LaneIndex]; };
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				Row(ContactBatchRow_RelativeVelocity + Axis) = RelativeVelocity[Axis];
+				Row(ContactBatchRow_Normal + Axis) = Contact.Normal[Axis];
+			}
+			Row(ContactBatchRow_Factor) = Factor.M[0][0];
+			Row(ContactBatchRow_Factor + 1) = Factor.M[0][1];
+			Row(ContactBatchRow_Factor + 2) = Factor.M[0][2];
+			Row(ContactBatchRow_Factor + 3) = Factor.M[1][1];
+			Row(ContactBatchRow_Factor + 4) = Factor.M[1][2];
+			Row(ContactBatchRow_Factor + 5) = Factor.M[2][2];
+			Row(ContactBatchRow_Friction) = Contact.Friction;
+			Row(ContactBatchRow_Restitution) = bApplyRestitution ? Contact.Restitution : (FReal)0;
+
+			return true;
+		}
+
+		// Scatter one solved contact back to its particles. Mirrors the end of ApplyContact.
+		static void ScatterContactBatchLane(const FContactBatchLane& Lane, const FVec3& SolvedImpulse, const FContactIterationParameters& IterationParameters)
+		{
+			FVec3 Impulse = SolvedImpulse;
+			if (Chaos_Collision_EnergyClampEnabled != 0)
+			{
+				Impulse = GetEnergyClampedImpulse(Lane.PBDRigid0, Lane.PBDRigid1, Impulse, Lane.VectorToPoint1, Lane.VectorToPoint2, Lane.Body1Velocity, Lane.Body2Velocity);
+			}
+			*Lane.AccumulatedImpulse += Impulse;
+
+			if (Lane.bIsRigidDynamic0)
+			{
+				// Velocity update for next step
+				const FVec3 NetAngularImpulse = FVec3::CrossProduct(Lane.VectorToPoint1, Impulse);
+				const FVec3 DV = Lane.PBDRigid0->InvM() * Impulse;
+				const FVec3 DW = Lane.WorldSpaceInvI1 * NetAngularImpulse;
+				Lane.PBDRigid0->V() += DV;
+				Lane.PBDRigid0->W() += DW;
+				// Position update as part of pbd
+				const FVec3 P0 = Lane.P0 + (DV * IterationParameters.Dt);
+				FRotation3 Q0 = Lane.Q0 + FRotation3::FromElements(DW, 0.f) * Lane.Q0 * IterationParameters.Dt * FReal(0.5);
+				Q0.Normalize();
+				FParticleUtilities::SetCoMWorldTransform(Lane.PBDRigid0, P0, Q0);
+			}
+			if (Lane.bIsRigidDynamic1)
+			{
+				// Velocity update for next step
+				const FVec3 NetAngularImpulse = FVec3::CrossProduct(Lane.VectorToPoint2, -Impulse);
+				const FVec3 DV = -Lane.PBDRigid1->InvM() * Impulse;
+				const FVec3 DW = Lane.WorldSpaceInvI2 * NetAngularImpulse;
+				Lane.PBDRigid1->V() += DV;
+				Lane.PBDRigid1->W() += DW;
+				// Position update as part of pbd
+				const FVec3 P1 = Lane.P1 + (DV * IterationParameters.Dt);
+				FRotation3 Q1 = Lane.Q1 + FRotation3::FromElements(DW, 0.f) * Lane.Q1 * IterationParameters.Dt * FReal(0.5);
+				Q1.Normalize();
+				FParticleUtilities::SetCoMWorldTransform(Lane.PBDRigid1, P1, Q1);
+			}
+		}
+
+		// Apply a set of contacts that share no dynamic particles (e.g., one color of an island) with a single pair iteration.
+		// The contacts are gathered into structure-of-arrays lanes, their impulses solved together, and the results scattered back.
+		// Contacts that the batch does not support go through the regular Apply.
+		void ApplyBatch(FCollisionConstraintBase* const* Constraints, const int32 NumConstraints, const FContactIterationParameters& IterationParameters, const FContactParticleParameters& ParticleParameters)
+		{
+			bool bUseVelocityMode = (IterationParameters.ApplyType == ECollisionApplyType::Velocity);
+			if (Chaos_Collision_ForceApplyType != 0)
+			{
+				bUseVelocityMode = (Chaos_Collision_ForceApplyType == (int32)ECollisionApplyType::Velocity);
+			}
+			const bool bCanBatch = bUseVelocityMode && (IterationParameters.NumPairIterations == 1) && !Chaos_Collision_UseAccumulatedImpulseClipSolve;
+
+			float Data[ContactBatchRow_Num * ContactBatchNumLanes];
+			FContactBatchLane Lanes[ContactBatchNumLanes];
+
+			for (int32 BatchStart = 0; BatchStart < NumConstraints; BatchStart += ContactBatchNumLanes)
+			{
+				const int32 BatchEnd = FMath::Min(BatchStart + ContactBatchNumLanes, NumConstraints);
+				int32 NumLanes = 0;
+				for (int32 ConstraintIndex = BatchStart; ConstraintIndex < BatchEnd; ++ConstraintIndex)
+				{
+					FCollisionConstraintBase& Constraint = *Constraints[ConstraintIndex];
+					if (bCanBatch && (Constraint.GetType() == FCollisionConstraintBase::FType::SinglePoint))
+					{
+						NumLanes += GatherContactBatchLane(*Constraint.As<FRigidBodyPointContactConstraint>(), IterationParameters, ParticleParameters, Lanes[NumLanes], Data, NumLanes) ? 1 : 0;
+					}
+					else if (bCanBatch && (Constraint.GetType() == FCollisionConstraintBase::FType::MultiPoint))
+					{
+						NumLanes += GatherContactBatchLane(*Constraint.As<FRigidBodyMultiPointContactConstraint>(), IterationParameters, ParticleParameters, Lanes[NumLanes], Data, NumLanes) ? 1 : 0;
+					}
+					else
+					{
+						Apply(Constraint, IterationParameters, ParticleParameters);
+					}
+				}
+
+				if (NumLanes == 0)
+				{
+					continue;
+				}
+
+#if INTEL_ISPC
+				ispc::ApplyContactVelocityBatch(Data, ContactBatchNumLanes, NumLanes);
+#else
+				ApplyContactVelocityBatchScalar(Data, ContactBatchNumLanes, NumLanes);
+#endif
+
+				for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+				{
+					const FVec3 Impulse(
+						Data[ContactBatchRow_Impulse * ContactBatchNumLanes + LaneIndex],
+						Data[(ContactBatchRow_Impulse + 1) * ContactBatchNumLanes + LaneIndex],
+						Data[(ContactBatchRow_Impulse + 2) * ContactBatchNumLanes + LaneIndex]);
+					ScatterContactBatchLane(Lanes[LaneIndex], Impulse, IterationParameters);
+				}
+			}
+		}
+
 		void ApplySinglePoint(FRigidBodyPointContactConstraint& Constraint, const FContactIterationParameters & IterationParameters, const FContactParticleParameters & ParticleParameters)
 		{
 			ApplyImpl<FRigidBodyPointContactConstraint>(Constraint, IterationParameters, ParticleParameters);
@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "Chaos/PBDCollisionConstraintsContact.h"
+
+namespace Chaos
+{
+	namespace Collisions
+	{
+		// Apply a set of contacts that share no dynamic particles (e.g., one color of an island) with a single pair iteration,
+		// solving their impulses together in structure-of-arrays lanes. Defined in PBDCollisionConstraintsContact.cpp.
+		void ApplyBatch(FCollisionConstraintBase* const* Constraints, const int32 NumConstraints, const FContactIterationParameters& IterationParameters, const FContactParticleParameters& ParticleParameters);
+	}
+}
@@ -346,6 +346,10 @@ void TPBDCollisionConstraintPGS<T, d>::Solve(T_PARTICLES& InParticles, const T D
 		for (int32 ConstraintIndex : InConstraintIndices)
 		{
 			FRigidBodyContactConstraint& Constraint = Constraints[ConstraintIndex];
+			// The pair's friction doesn't change during the solve, don't chase the material pointers for every point
+			const T Friction = MPhysicsMaterials[Constraint.LevelsetIndex]
+				? FMath::Max(MPhysicsMaterials[Constraint.ParticleIndex]->Friction, MPhysicsMaterials[Constraint.LevelsetIndex]->Friction)
+				: MPhysicsMaterials[Constraint.ParticleIndex]->Friction;
 			for (int32 PointIndex = 0; PointIndex < Constraint.Phi.Num(); ++PointIndex)
 			{
 				T Body1NormalVelocity = TVector<T, d>::DotProduct(InParticles.V(Constraint.ParticleIndex), Constraint.Normal[PointIndex]) +
@@ -374,9 +378,6 @@ void TPBDCollisionConstraintPGS<T, d>::Solve(T_PARTICLES& InParticles, const T D
 				InParticles.W(Constraint.LevelsetIndex) += NormalDelta * MassWeightedAngulars[FlattenedIndex][1];
 				// Normal update
 				Normals[FlattenedIndex] = NewNormal;
-				T Friction = MPhysicsMaterials[Constraint.LevelsetIndex]
-					? FMath::Max(MPhysicsMaterials[Constraint.ParticleIndex]->Friction, MPhysicsMaterials[Constraint.LevelsetIndex]->Friction)
-					: MPhysicsMaterials[Constraint.ParticleIndex]->Friction;
 				if (Friction)
 				{
 					for (int32 Dimension = 0; Dimension < (d - 1); Dimension++)
@@ -640,8 +641,8 @@ void RemovePointsInsideHull(TRigidBodyContactConstraintPGS<T, d>& Constraint)
 template<class T, int d>
 void TPBDCollisionConstraintPGS<T, d>::Apply(TPBDRigidParticles<T, d>& InParticles, const T Dt, const TArray<int32>& InConstraintIndices)
 {
-	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 ConstraintIndex) {
-		FRigidBodyContactConstraint& Constraint = Constraints[ConstraintIndex];
+	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 Index) {
+		FRigidBodyContactConstraint& Constraint = Constraints[InConstraintIndices[Index]];
 		if (InParticles.Sleeping(Constraint.ParticleIndex))
 		{
 			check(InParticles.Sleeping(Constraint.LevelsetIndex) || InParticles.InvM(Constraint.LevelsetIndex) == 0);
@@ -664,8 +665,8 @@ void TPBDCollisionConstraintPGS<T, d>::Apply(TPBDRigidParticles<T, d>& InParticl
 template<class T, int d>
 void TPBDCollisionConstraintPGS<T, d>::ApplyPushOut(TPBDRigidParticles<T, d>& InParticles, const T Dt, const TArray<int32>& InConstraintIndices)
 {
-	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 ConstraintIndex) {
-		FRigidBodyContactConstraint& Constraint = Constraints[ConstraintIndex];
+	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 Index) {
+		FRigidBodyContactConstraint& Constraint = Constraints[InConstraintIndices[Index]];
 		if (InParticles.Sleeping(Constraint.ParticleIndex))
 		{
 			check(InParticles.Sleeping(Constraint.LevelsetIndex) || InParticles.InvM(Constraint.LevelsetIndex) == 0);
@@ -707,20 +708,23 @@ void TPBDCollisionConstraintPGS<T, d>::ApplyPushOut(TPBDRigidParticles<T, d>& In
 		}
 	};
 
-	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 ConstraintIndex) {
+	// Constraints share particles, so the save/restore passes stay serial to keep the Saved flags race free
+	for (const int32 ConstraintIndex : InConstraintIndices)
+	{
 		SaveParticle(Constraints[ConstraintIndex].ParticleIndex);
 		SaveParticle(Constraints[ConstraintIndex].LevelsetIndex);
-	});
+	}
 	PrintParticles(InParticles, InConstraintIndices);
 	PrintConstraints(InParticles, InConstraintIndices);
 
 	Solve(InParticles, Dt, InConstraintIndices);
 	
 	PrintParticles(InParticles, InConstraintIndices);
-	PhysicsParallelFor(InConstraintIndices.Num(), [&](int32 ConstraintIndex) {
+	for (const int32 ConstraintIndex : InConstraintIndices)
+	{
 		RestoreParticle(Constraints[ConstraintIndex].ParticleIndex);
 		RestoreParticle(Constraints[ConstraintIndex].LevelsetIndex);
-	});
+	}
 }
 
 template<class T, int d>
@@ -62,6 +62,7 @@ PBDCollisionSpringConstraintsBase<T, d>::PBDCollisionSpringConstraintsBase(
 #if PLATFORM_DESKTOP && PLATFORM_64BITS
 	TkDOPTree<const FMeshBuildDataProvider, uint32> DopTree;
 	TArray<FkDOPBuildCollisionTriangle<uint32>> BuildTraingleArray;
+	BuildTraingleArray.Reserve(Elements.Num());
 	for (int32 i = 0; i < Elements.Num(); ++i)
 	{
 		const auto& Elem = Elements[i];
@@ -69,8 +70,23 @@ PBDCollisionSpringConstraintsBase<T, d>::PBDCollisionSpringConstraintsBase(
 	}
 	DopTree.Build(BuildTraingleArray);
 	FMeshBuildDataProvider DopDataProvider(DopTree);
-	FCriticalSection CriticalSection;
-	PhysicsParallelFor(InParticles.Size(), [&](int32 Index) {
+
+	// Each particle yields at most one constraint, so write candidates to per
+	// particle slots and compact them afterwards.  This avoids serializing the
+	// parallel ray casts on a lock and keeps the constraint order deterministic.
+	const int32 NumParticles = (int32)InParticles.Size();
+	TArray<int32> HitElements;
+	HitElements.Init(INDEX_NONE, NumParticles);
+	TArray<TVector<T, 3>> HitBarys;
+	HitBarys.SetNumUninitialized(NumParticles);
+	TArray<TVector<T, d>> HitNormals;
+	HitNormals.SetNumUninitialized(NumParticles);
+	PhysicsParallelFor(NumParticles, [&](int32 Index) {
+		// A particle at rest casts a zero length ray, which can never hit
+		if (InParticles.V(Index).IsZero())
+		{
+			return;
+		}
 		FkHitResult Result;
 		const auto& Start = InParticles.X(Index);
 		const auto End = Start + InParticles.V(Index) * Dt + InParticles.V(Index).GetSafeNormal() * MH;
@@ -99,13 +115,30 @@ PBDCollisionSpringConstraintsBase<T, d>::PBDCollisionSpringConstraintsBase(
 			//if (Bary.Y < 0 || Bary.Z < 0 || Bary.X < 0) return;
 			// TODO(mlentine): Incorporate history
 			TVector<T, d> Normal = TVector<T, d>::DotProduct(Result.Normal, PP0) > 0 ? Result.Normal : -Result.Normal;
-			CriticalSection.Lock();
-			MConstraints.Add({Index, Elem[0], Elem[1], Elem[2]});
-			MBarys.Add(Bary);
-			MNormals.Add(Normal);
-			CriticalSection.Unlock();
+			HitElements[Index] = Result.Item;
+			HitBarys[Index] = Bary;
+			HitNormals[Index] = Normal;
 		}
 	});
+
+	int32 NumHits = 0;
+	for (const int32 HitElement : HitElements)
+	{
+		NumHits += HitElement != INDEX_NONE ? 1 : 0;
+	}
+	MConstraints.Reserve(NumHits);
+	MBarys.Reserve(NumHits);
+	MNormals.Reserve(NumHits);
+	for (int32 Index = 0; Index < NumParticles; ++Index)
+	{
+		if (HitElements[Index] != INDEX_NONE)
+		{
+			const auto& Elem = Elements[HitElements[Index]];
+			MConstraints.Add({Index, Elem[0], Elem[1], Elem[2]});
+			MBarys.Add(HitBarys[Index]);
+			MNormals.Add(HitNormals[Index]);
+		}
+	}
 #endif
 }
 
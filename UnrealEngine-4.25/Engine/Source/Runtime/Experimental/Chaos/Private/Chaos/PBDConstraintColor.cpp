@@ -22,6 +22,10 @@ using namespace Chaos;
 DECLARE_CYCLE_STAT(TEXT("FPBDConstraintColor::ComputeColors"), STAT_Constraint_ComputeColor, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDConstraintColor::ComputeContactGraph"), STAT_Constraint_ComputeContactGraph, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDConstraintColor::ComputeIslandColoring"), STAT_Constraint_ComputeIslandColoring, STATGROUP_Chaos);
+DECLARE_CYCLE_STAT(TEXT("FPBDConstraintColor::BalanceIslandColoring"), STAT_Constraint_BalanceIslandColoring, STATGROUP_Chaos);
+
+int32 ChaosConstraintColorMinBatchSize = 8;
+FAutoConsoleVariableRef CVarChaosConstraintColorMinBatchSize(TEXT("p.Chaos.ConstraintColor.MinBatchSize"), ChaosConstraintColorMinBatchSize, TEXT("Colors with fewer constraints than this try to move them into larger, compatible colors of the same level. 0 to disable.[def:8]"));
 
 void FPBDConstraintColor::ComputeIslandColoring(const int32 Island, const FPBDConstraintGraph& ConstraintGraph, uint32 ContainerId)
 {
@@ -168,6 +172,83 @@ void FPBDConstraintColor::ComputeIslandColoring(const int32 Island, const FPBDCo
 			}
 		}
 	}
+
+	// Greedy coloring leaves a tail of colors holding only a handful of constraints, and every color is a separate
+	// parallel batch. Move constraints out of the small colors into the largest color of the same level that neither
+	// of their dynamic nodes already uses. Node UsedColors holds exactly the colors of its edges so it stays valid.
+	if (ChaosConstraintColorMinBatchSize > 0 && MaxColor > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Constraint_BalanceIslandColoring);
+
+		auto IsNodeDynamic = [&ConstraintGraph](const int32 NodeIndex)
+		{
+			if (NodeIndex == INDEX_NONE)
+			{
+				return false;
+			}
+			const TGeometryParticleHandle<FReal, 3>* Particle = ConstraintGraph.Nodes[NodeIndex].Particle;
+			return Particle && Particle->CastToRigidParticle() && Particle->ObjectState() == EObjectStateType::Dynamic;
+		};
+
+		for (const int32 EdgeIndex : ConstraintGraph.GetIslandConstraintData(Island))
+		{
+			const typename FPBDConstraintGraph::FGraphEdge& GraphEdge = ConstraintGraph.Edges[EdgeIndex];
+			FGraphEdgeColor& ColorEdge = Edges[EdgeIndex];
+			if ((GraphEdge.Data.GetContainerId() != ContainerId) || (ColorEdge.Color < 0) || !LevelToColorToConstraintListMap.IsValidIndex(ColorEdge.Level))
+			{
+				continue;
+			}
+
+			auto& ColorToConstraintList = LevelToColorToConstraintListMap[ColorEdge.Level];
+			auto* FromList = ColorToConstraintList.Find(ColorEdge.Color);
+			if (!FromList || FromList->Num() >= ChaosConstraintColorMinBatchSize)
+			{
+				continue;
+			}
+
+			FGraphNodeColor* ColorNode0 = IsNodeDynamic(GraphEdge.FirstNode) ? &Nodes[GraphEdge.FirstNode] : nullptr;
+			FGraphNodeColor* ColorNode1 = IsNodeDynamic(GraphEdge.SecondNode) ? &Nodes[GraphEdge.SecondNode] : nullptr;
+
+			int32 BestColor = INDEX_NONE;
+			int32 BestNum = FromList->Num();
+			for (const auto& ColorToList : ColorToConstraintList)
+			{
+				const int32 Color = ColorToList.Key;
+				const int32 Num = ColorToList.Value.Num();
+				const bool bIsBetter = (Num > BestNum) || ((Num == BestNum) && (BestColor != INDEX_NONE) && (Color < BestColor));
+				if ((Color != ColorEdge.Color) && bIsBetter
+					&& !(ColorNode0 && ColorNode0->UsedColors.Contains(Color))
+					&& !(ColorNode1 && ColorNode1->UsedColors.Contains(Color)))
+				{
+					BestColor = Color;
+					BestNum = Num;
+				}
+			}
+
+			if (BestColor != INDEX_NONE)
+			{
+				auto* ConstraintHandle = GraphEdge.Data.GetConstraintHandle();
+				FromList->RemoveSingleSwap(ConstraintHandle, /*bAllowShrinking=*/false);
+				if (FromList->Num() == 0)
+				{
+					ColorToConstraintList.Remove(ColorEdge.Color);
+				}
+				ColorToConstraintList[BestColor].Add(ConstraintHandle);
+
+				if (ColorNode0)
+				{
+					ColorNode0->UsedColors.Remove(ColorEdge.Color);
+					ColorNode0->UsedColors.Add(BestColor);
+				}
+				if (ColorNode1)
+				{
+					ColorNode1->UsedColors.Remove(ColorEdge.Color);
+					ColorNode1->UsedColors.Add(BestColor);
+				}
+				ColorEdge.Color = BestColor;
+			}
+		}
+	}
 }
 
 void FPBDConstraintColor::ComputeContactGraph(const int32 Island, const FPBDConstraintGraph& ConstraintGraph, uint32 ContainerId)
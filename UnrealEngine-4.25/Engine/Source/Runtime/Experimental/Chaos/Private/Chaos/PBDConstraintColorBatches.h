@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "Chaos/Core.h"
+#include "Chaos/Framework/Parallel.h"
+#include "Chaos/ParticleHandle.h"
+#include "HAL/ThreadSingleton.h"
+
+namespace Chaos
+{
+	/**
+	 * Two-particle constraints split into batches where no two constraints share a dynamic particle, so the constraints of
+	 * a batch can be solved in parallel. Shared by the joint and rigid spring containers.
+	 *
+	 * Each run of equal level is greedily colored and emitted color by color, keeping the input order within a color.
+	 * Order lists input positions batch by batch and BatchEnds holds the end of each batch in Order. The batching only
+	 * depends on the input order, so the solve stays deterministic.
+	 */
+	struct FConstraintColorBatches
+	{
+		TArray<int32> Order;
+		TArray<int32> BatchEnds;
+
+		template<typename FGetLevel, typename FGetParticles>
+		void Build(const int32 Num, const FGetLevel& GetLevel, const FGetParticles& GetParticles)
+		{
+			Order.Reset(Num);
+			BatchEnds.Reset();
+
+			TMap<const TGeometryParticleHandle<FReal, 3>*, int32> NextParticleColor;
+			TArray<int32> Colors;
+			TArray<int32> ColorOffsets;
+
+			int32 LevelBegin = 0;
+			while (LevelBegin < Num)
+			{
+				const int32 Level = GetLevel(LevelBegin);
+				int32 LevelEnd = LevelBegin + 1;
+				while ((LevelEnd < Num) && (GetLevel(LevelEnd) == Level))
+				{
+					++LevelEnd;
+				}
+
+				// A constraint takes the first color above every color already used by its dynamic particles.
+				// Static and kinematic particles are never written by the solver so they don't constrain the color.
+				NextParticleColor.Reset();
+				Colors.Reset();
+				int32 NumColors = 0;
+				for (int32 Index = LevelBegin; Index < LevelEnd; ++Index)
+				{
+					const TVector<TGeometryParticleHandle<FReal, 3>*, 2>& Particles = GetParticles(Index);
+					bool bIsDynamic[2];
+					int32 Color = 0;
+					for (int32 ParticleIndex = 0; ParticleIndex < 2; ++ParticleIndex)
+					{
+						const TGeometryParticleHandle<FReal, 3>* Particle = Particles[ParticleIndex];
+						bIsDynamic[ParticleIndex] = Particle && Particle->CastToRigidParticle() && Particle->ObjectState() == EObjectStateType::Dynamic;
+						if (bIsDynamic[ParticleIndex])
+						{
+							Color = FMath::Max(Color, NextParticleColor.FindRef(Particle));
+						}
+					}
+					for (int32 ParticleIndex = 0; ParticleIndex < 2; ++ParticleIndex)
+					{
+						if (bIsDynamic[ParticleIndex])
+						{
+							NextParticleColor.Add(Particles[ParticleIndex], Color + 1);
+						}
+					}
+					Colors.Add(Color);
+					NumColors = FMath::Max(NumColors, Color + 1);
+				}
+
+				// Counting sort the level by color
+				ColorOffsets.Reset();
+				ColorOffsets.SetNumZeroed(NumColors + 1);
+				for (const int32 Color : Colors)
+				{
+					++ColorOffsets[Color + 1];
+				}
+				for (int32 Color = 0; Color < NumColors; ++Color)
+				{
+					ColorOffsets[Color + 1] += ColorOffsets[Color];
+					BatchEnds.Add(Order.Num() + ColorOffsets[Color + 1]);
+				}
+				const int32 LevelOrderBegin = Order.Num();
+				Order.AddUninitialized(LevelEnd - LevelBegin);
+				for (int32 Index = LevelBegin; Index < LevelEnd; ++Index)
+				{
+					Order[LevelOrderBegin + ColorOffsets[Colors[Index - LevelBegin]]++] = Index;
+				}
+
+				LevelBegin = LevelEnd;
+			}
+		}
+
+		/** Call Solve(OrderIndex, Index) for every entry, batch by batch, going wide within a batch of at least MinParallelBatchSize. */
+		template<typename FSolveFunction>
+		void Solve(const int32 MinParallelBatchSize, const FSolveFunction& SolveFunction) const
+		{
+			int32 BatchBegin = 0;
+			for (const int32 BatchEnd : BatchEnds)
+			{
+				const int32 BatchSize = BatchEnd - BatchBegin;
+				PhysicsParallelFor(BatchSize, [&](int32 BatchIndex)
+					{
+						const int32 OrderIndex = BatchBegin + BatchIndex;
+						SolveFunction(OrderIndex, Order[OrderIndex]);
+					}, BatchSize < MinParallelBatchSize);
+				BatchBegin = BatchEnd;
+			}
+		}
+	};
+
+	/**
+	 * Batches built on the first iteration of a solve and reused by its later iterations, one slot per container. The
+	 * constraint set and particle states can't change between the iterations of a step, but a container has no per-step
+	 * storage to keep them in, so they are cached on the solving thread. An island is solved on a single thread for all its
+	 * iterations. Any mismatch with the cached constraint list rebuilds.
+	 */
+	class FConstraintColorBatchCache : public TThreadSingleton<FConstraintColorBatchCache>
+	{
+	public:
+		template<typename FGetLevel, typename FGetParticles>
+		const FConstraintColorBatches& FindOrBuild(const void* Container, const void* Constraints, const int32 Num, const int32 It, const FGetLevel& GetLevel, const FGetParticles& GetParticles)
+		{
+			FEntry* Entry = Entries.FindByPredicate([Container](const FEntry& Candidate) { return Candidate.Container == Container; });
+			if (Entry == nullptr)
+			{
+				// Containers come and go, so the slots are recycled rather than growing without bound
+				if (Entries.Num() < MaxEntries)
+				{
+					Entry = &Entries.AddDefaulted_GetRef();
+				}
+				else
+				{
+					Entry = &Entries[NextEntryToRecycle];
+					NextEntryToRecycle = (NextEntryToRecycle + 1) % MaxEntries;
+				}
+				Entry->Container = Container;
+			}
+			else if ((It > 0) && (Entry->Constraints == Constraints) && (Entry->Num == Num))
+			{
+				return Entry->Batches;
+			}
+
+			Entry->Constraints = Constraints;
+			Entry->Num = Num;
+			Entry->Batches.Build(Num, GetLevel, GetParticles);
+			return Entry->Batches;
+		}
+
+	private:
+		struct FEntry
+		{
+			const void* Container = nullptr;
+			const void* Constraints = nullptr;
+			int32 Num = 0;
+			FConstraintColorBatches Batches;
+		};
+
+		static constexpr int32 MaxEntries = 4;
+		TArray<FEntry, TInlineAllocator<MaxEntries>> Entries;
+		int32 NextEntryToRecycle = 0;
+	};
+}
@@ -26,6 +26,9 @@ FAutoConsoleVariableRef CVarChaosSolverCollisionDefaultLinearSleepThreshold(TEXT
 float ChaosSolverCollisionDefaultAngularSleepThresholdCVar = 0.0087f;  //~1/2 unit mass degree
 FAutoConsoleVariableRef CVarChaosSolverCollisionDefaultAngularSleepThreshold(TEXT("p.ChaosSolverCollisionDefaultAngularSleepThreshold"), ChaosSolverCollisionDefaultAngularSleepThresholdCVar, TEXT("Default angular threshold for sleeping.[def:0.0087]"));
 
+int32 ChaosSolverIslandUnionFindCVar = 1;
+FAutoConsoleVariableRef CVarChaosSolverIslandUnionFind(TEXT("p.ChaosSolverIslandUnionFind"), ChaosSolverIslandUnionFindCVar, TEXT("Build islands with union-find over the graph edges and keep island indices stable across frames.[def:1]"));
+
 FPBDConstraintGraph::FPBDConstraintGraph() : VisitToken(0)
 {
 }
@@ -311,7 +314,7 @@ void FPBDConstraintGraph::ComputeIslands(const TParticleView<TPBDRigidParticles<
 	SCOPE_CYCLE_COUNTER(STAT_IslandGeneration2);
 
 	int32 NextIsland = 0;
-	TArray<TSet<TGeometryParticleHandle<FReal, 3>*>> NewIslandParticles;
+	TArray<TArray<TGeometryParticleHandle<FReal, 3>*>> NewIslandParticles;
 	TArray<int32> NewIslandToSleepCount;
 
 	VisitToken++;
@@ -331,37 +334,237 @@ void FPBDConstraintGraph::ComputeIslands(const TParticleView<TPBDRigidParticles<
 		}
 	});
 
-	for (auto& Particle : PBDRigids)
+	if (ChaosSolverIslandUnionFindCVar)
 	{
-		auto* ParticleHandle = Particle.Handle();
-		int32 Idx = ParticleToNodeIndex[ParticleHandle];  // ryan - FAILS!
-		// selective reset of islands, don't reset if has been visited due to being edge connected to earlier processed node
-		if (Visited[Idx] && Visited[Idx] != VisitToken)
+		// Only dynamic nodes are merged into islands. Static and kinematic nodes are shared between all the islands they touch.
+		auto IsDynamicNode = [this](const int32 NodeIndex)
+		{
+			const TPBDRigidParticleHandle<FReal, 3>* RigidHandle = Nodes[NodeIndex].Particle ? Nodes[NodeIndex].Particle->CastToRigidParticle() : nullptr;
+			return RigidHandle && RigidHandle->ObjectState() != EObjectStateType::Kinematic;
+		};
+
+		// Union-find over the edges, with path halving. Linking to the lower root keeps the result independent of edge order.
+		TArray<int32> NodeParent;
+		NodeParent.SetNumUninitialized(Nodes.Num());
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
 		{
-			Nodes[Idx].Island = INDEX_NONE;
-			Visited[Idx] = VisitToken;
+			NodeParent[NodeIndex] = NodeIndex;
 		}
+		auto FindRoot = [&NodeParent](int32 NodeIndex)
+		{
+			while (NodeParent[NodeIndex] != NodeIndex)
+			{
+				NodeParent[NodeIndex] = NodeParent[NodeParent[NodeIndex]];
+				NodeIndex = NodeParent[NodeIndex];
+			}
+			return NodeIndex;
+		};
 
-		if (Nodes[Idx].Island >= 0)
+		for (const FGraphEdge& Edge : Edges)
 		{
-			// Island is already known - it was visited in ComputeIsland for a previous node
-			continue;
+			if ((Edge.FirstNode != INDEX_NONE) && (Edge.SecondNode != INDEX_NONE) && IsDynamicNode(Edge.FirstNode) && IsDynamicNode(Edge.SecondNode))
+			{
+				const int32 Root0 = FindRoot(Edge.FirstNode);
+				const int32 Root1 = FindRoot(Edge.SecondNode);
+				if (Root0 < Root1)
+				{
+					NodeParent[Root1] = Root0;
+				}
+				else if (Root1 < Root0)
+				{
+					NodeParent[Root0] = Root1;
+				}
+			}
 		}
 
-		TSet<TGeometryParticleHandle<FReal, 3>*> SingleIslandParticles;
-		TSet<TGeometryParticleHandle<FReal, 3>*> SingleIslandStaticParticles;
-		ComputeIsland(Idx, NextIsland, SingleIslandParticles, SingleIslandStaticParticles);
+		// Remember which island each dynamic node was in last frame so that unchanged islands can keep their index
+		TArray<int32> NodeToPrevIsland;
+		NodeToPrevIsland.Init(INDEX_NONE, Nodes.Num());
+		for (int32 PrevIsland = 0; PrevIsland < IslandToParticles.Num(); ++PrevIsland)
+		{
+			for (TGeometryParticleHandle<FReal, 3>* Particle : IslandToParticles[PrevIsland])
+			{
+				const int32* NodeIndex = Particle ? ParticleToNodeIndex.Find(Particle) : nullptr;
+				if (NodeIndex && IsDynamicNode(*NodeIndex))
+				{
+					NodeToPrevIsland[*NodeIndex] = PrevIsland;
+				}
+			}
+		}
 
-		for (TGeometryParticleHandle<FReal, 3>* StaticParticle : SingleIslandStaticParticles)
+		// Components are seeded from the rigids view in iteration order, exactly like the breadth-first path.
+		// Dynamic nodes only reachable through edges join the component of their root; unseeded components get no island.
+		const int32 MixedPrevIsland = INDEX_NONE - 1;
+		TArray<int32> RootToComponent;
+		RootToComponent.Init(INDEX_NONE, Nodes.Num());
+		TArray<TArray<TGeometryParticleHandle<FReal, 3>*>> ComponentParticles;
+		TArray<int32> ComponentPrevIsland;
+		TArray<int32> NodeComponent;
+		NodeComponent.Init(INDEX_NONE, Nodes.Num());
+
+		auto AddDynamicNode = [&](const int32 NodeIndex, const int32 Component)
 		{
-			SingleIslandParticles.Add(StaticParticle);
+			NodeComponent[NodeIndex] = Component;
+			Visited[NodeIndex] = VisitToken;
+			ComponentParticles[Component].Add(Nodes[NodeIndex].Particle);
+
+			const int32 PrevIsland = NodeToPrevIsland[NodeIndex];
+			int32& ComponentPrev = ComponentPrevIsland[Component];
+			if (ComponentPrev == INDEX_NONE)
+			{
+				ComponentPrev = PrevIsland;
+			}
+			else if ((PrevIsland != INDEX_NONE) && (PrevIsland != ComponentPrev))
+			{
+				ComponentPrev = MixedPrevIsland;
+			}
+		};
+
+		for (auto& Particle : PBDRigids)
+		{
+			const int32 Idx = ParticleToNodeIndex[Particle.Handle()];
+			if (NodeComponent[Idx] != INDEX_NONE)
+			{
+				continue;
+			}
+
+			if (!IsDynamicNode(Idx))
+			{
+				// Matches ComputeIsland: a non-dynamic start node becomes an island containing only itself
+				ComponentParticles.AddDefaulted_GetRef().Add(Nodes[Idx].Particle);
+				ComponentPrevIsland.Add(INDEX_NONE);
+				continue;
+			}
+
+			const int32 Root = FindRoot(Idx);
+			if (RootToComponent[Root] == INDEX_NONE)
+			{
+				RootToComponent[Root] = ComponentParticles.Num();
+				ComponentParticles.AddDefaulted();
+				ComponentPrevIsland.Add(INDEX_NONE);
+			}
+			AddDynamicNode(Idx, RootToComponent[Root]);
 		}
 
-		if (SingleIslandParticles.Num())
+		// Add the dynamic nodes reached only through edges, and pair each component with the static nodes it touches
+		TArray<TPair<int32, int32>> ComponentStaticNodes;
+		auto AddEdgeNode = [&](const int32 NodeIndex, const int32 OtherNodeIndex)
 		{
-			NewIslandParticles.SetNum(NextIsland + 1);
-			NewIslandParticles[NextIsland] = MoveTemp(SingleIslandParticles);
-			NextIsland++;
+			if (NodeIndex == INDEX_NONE || !IsDynamicNode(NodeIndex))
+			{
+				return;
+			}
+			const int32 Component = RootToComponent[FindRoot(NodeIndex)];
+			if (Component == INDEX_NONE)
+			{
+				return;
+			}
+			if (NodeComponent[NodeIndex] == INDEX_NONE)
+			{
+				AddDynamicNode(NodeIndex, Component);
+			}
+			if ((OtherNodeIndex != INDEX_NONE) && Nodes[OtherNodeIndex].Particle && !IsDynamicNode(OtherNodeIndex))
+			{
+				ComponentStaticNodes.Emplace(Component, OtherNodeIndex);
+			}
+		};
+		for (const FGraphEdge& Edge : Edges)
+		{
+			AddEdgeNode(Edge.FirstNode, Edge.SecondNode);
+			AddEdgeNode(Edge.SecondNode, Edge.FirstNode);
+		}
+
+		ComponentStaticNodes.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+		{
+			return (A.Key != B.Key) ? (A.Key < B.Key) : (A.Value < B.Value);
+		});
+		for (int32 PairIndex = 0; PairIndex < ComponentStaticNodes.Num(); ++PairIndex)
+		{
+			if ((PairIndex == 0) || (ComponentStaticNodes[PairIndex] != ComponentStaticNodes[PairIndex - 1]))
+			{
+				ComponentParticles[ComponentStaticNodes[PairIndex].Key].Add(Nodes[ComponentStaticNodes[PairIndex].Value].Particle);
+			}
+		}
+
+		// A component made up entirely of particles from one previous island keeps that island's index if it is still
+		// in range and no earlier component claimed it. Everything else takes the lowest free index, in seed order.
+		const int32 NumComponents = ComponentParticles.Num();
+		TArray<int32> ComponentToIsland;
+		ComponentToIsland.Init(INDEX_NONE, NumComponents);
+		TArray<bool> IslandClaimed;
+		IslandClaimed.Init(false, NumComponents);
+		for (int32 Component = 0; Component < NumComponents; ++Component)
+		{
+			const int32 PrevIsland = ComponentPrevIsland[Component];
+			if ((PrevIsland >= 0) && (PrevIsland < NumComponents) && !IslandClaimed[PrevIsland])
+			{
+				ComponentToIsland[Component] = PrevIsland;
+				IslandClaimed[PrevIsland] = true;
+			}
+		}
+		int32 NextFreeIsland = 0;
+		for (int32 Component = 0; Component < NumComponents; ++Component)
+		{
+			if (ComponentToIsland[Component] == INDEX_NONE)
+			{
+				while (IslandClaimed[NextFreeIsland])
+				{
+					++NextFreeIsland;
+				}
+				ComponentToIsland[Component] = NextFreeIsland;
+				IslandClaimed[NextFreeIsland] = true;
+			}
+		}
+
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+		{
+			if (NodeComponent[NodeIndex] != INDEX_NONE)
+			{
+				Nodes[NodeIndex].Island = ComponentToIsland[NodeComponent[NodeIndex]];
+			}
+		}
+
+		NewIslandParticles.SetNum(NumComponents);
+		for (int32 Component = 0; Component < NumComponents; ++Component)
+		{
+			NewIslandParticles[ComponentToIsland[Component]] = MoveTemp(ComponentParticles[Component]);
+		}
+		NextIsland = NumComponents;
+	}
+	else
+	{
+		for (auto& Particle : PBDRigids)
+		{
+			auto* ParticleHandle = Particle.Handle();
+			int32 Idx = ParticleToNodeIndex[ParticleHandle];  // ryan - FAILS!
+			// selective reset of islands, don't reset if has been visited due to being edge connected to earlier processed node
+			if (Visited[Idx] && Visited[Idx] != VisitToken)
+			{
+				Nodes[Idx].Island = INDEX_NONE;
+				Visited[Idx] = VisitToken;
+			}
+
+			if (Nodes[Idx].Island >= 0)
+			{
+				// Island is already known - it was visited in ComputeIsland for a previous node
+				continue;
+			}
+
+			TSet<TGeometryParticleHandle<FReal, 3>*> SingleIslandParticles;
+			TSet<TGeometryParticleHandle<FReal, 3>*> SingleIslandStaticParticles;
+			ComputeIsland(Idx, NextIsland, SingleIslandParticles, SingleIslandStaticParticles);
+
+			for (TGeometryParticleHandle<FReal, 3>* StaticParticle : SingleIslandStaticParticles)
+			{
+				SingleIslandParticles.Add(StaticParticle);
+			}
+
+			if (SingleIslandParticles.Num())
+			{
+				NewIslandParticles.SetNum(NextIsland + 1);
+				NewIslandParticles[NextIsland] = SingleIslandParticles.Array();
+				NextIsland++;
+			}
 		}
 	}
 
@@ -520,12 +723,7 @@ void FPBDConstraintGraph::ComputeIslands(const TParticleView<TPBDRigidParticles<
 		}
 	}
 
-	IslandToParticles.Reset();
-	IslandToParticles.Reserve(NewIslandParticles.Num());
-	for (int32 Island = 0; Island < NewIslandParticles.Num(); ++Island)
-	{
-		IslandToParticles.Emplace(NewIslandParticles[Island].Array());
-	}
+	IslandToParticles = MoveTemp(NewIslandParticles);
 	IslandToSleepCount = MoveTemp(NewIslandToSleepCount);
 
 	check(IslandToParticles.Num() == IslandToSleepCount.Num());
@@ -13,6 +13,10 @@
 #include "Chaos/PerParticlePBDGroundConstraint.h"
 #include "Chaos/PerParticlePBDUpdateFromDeltaPosition.h"
 #include "ChaosStats.h"
+#include "HAL/IConsoleManager.h"
+#if INTEL_ISPC
+#include "PBDEvolution.ispc.generated.h"
+#endif
 
 
 DECLARE_CYCLE_STAT(TEXT("Chaos PBD Advance Time"), STAT_ChaosPBDVAdvanceTime, STATGROUP_Chaos);
@@ -24,10 +28,32 @@ DECLARE_CYCLE_STAT(TEXT("Chaos PBD Constraint Rule"), STAT_ChaosPBDConstraintRul
 DECLARE_CYCLE_STAT(TEXT("Chaos PBD Self Collision"), STAT_ChaosPBDSelfCollisionRule, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("Chaos PBD Collision"), STAT_ChaosPBDCollisionRule, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("Chaos PBD Collider Friction"), STAT_ChaosPBDCollisionRuleFriction, STATGROUP_Chaos);
-DECLARE_CYCLE_STAT(TEXT("Chaos PBD Collider Kinematic Update"), STAT_CollisionKinematicUpdate, STATGROUP_Chaos);
 
 using namespace Chaos;
 
+int32 ChaosPBDEvolutionMinParallelWork = 5000;
+FAutoConsoleVariableRef CVarChaosPBDEvolutionMinParallelWork(TEXT("p.Chaos.PBDEvolution.MinParallelWork"), ChaosPBDEvolutionMinParallelWork, TEXT("Estimated number of per-particle rule applications below which a cloth evolution loop runs single threaded. [def:5000]"));
+
+// Don't bother with threaded execution if we don't have enough work to make it worth while.
+// The work estimate is the number of items times the number of rules applied to each one,
+// so that cloths with many force rules or colliders go wide earlier than bare ones.
+static bool PBDEvolutionShouldRunSingleThreaded(const int32 NumItems, const int32 RulesPerItem)
+{
+	return (int64)NumItems * (int64)FMath::Max(RulesPerItem, 1) < (int64)ChaosPBDEvolutionMinParallelWork;
+}
+
+// Number of particles handed to each vectorized update call
+static const int32 PBDEvolutionISPCBatchSize = 1024;
+
+static void UpdateFromDeltaPositionHelperISPC(TPBDParticles<float, 3>& Particles, const float Dt, const int32 Offset, const int32 Range)
+{
+#if INTEL_ISPC
+	ispc::UpdateFromDeltaPosition((float*)&Particles.V(Offset), (float*)&Particles.X(Offset), (const float*)&Particles.P(Offset), Dt, Range * 3);
+#else
+	check(false);
+#endif
+}
+
 template<class T, int d>
 TPBDEvolution<T, d>::TPBDEvolution(TPBDParticles<T, d>&& InParticles, TKinematicGeometryClothParticles<T, d>&& InGeometryParticles, TArray<TVector<int32, 3>>&& CollisionTriangles,
     int32 NumIterations, T CollisionThickness, T SelfCollisionThickness, T CoefficientOfFriction, T Damping)
@@ -52,11 +78,22 @@ TPBDEvolution<T, d>::TPBDEvolution(TPBDParticles<T, d>&& InParticles, TKinematic
 		[PBDUpdateRule = 
 			TPerParticlePBDUpdateFromDeltaPosition<float, 3>()](TPBDParticles<T, d>& MParticlesInput, const T Dt) 
 			{
-				// Don't bother with threaded execution if we don't have enough work to make it worth while.
-				const bool NonParallelUpdate = MParticlesInput.Size() > 1000; // TODO: 1000 is a guess, tune this!
-				PhysicsParallelFor(MParticlesInput.Size(), [&](int32 Index) {
-					PBDUpdateRule.Apply(MParticlesInput, Dt, Index);
-				}, NonParallelUpdate);
+				const int32 NumParticles = (int32)MParticlesInput.Size();
+				const bool NonParallelUpdate = PBDEvolutionShouldRunSingleThreaded(NumParticles, 1);
+				if (INTEL_ISPC && NumParticles > 0)
+				{
+					const int32 NumBatches = FMath::DivideAndRoundUp(NumParticles, PBDEvolutionISPCBatchSize);
+					PhysicsParallelFor(NumBatches, [&](int32 BatchIndex) {
+						const int32 Offset = BatchIndex * PBDEvolutionISPCBatchSize;
+						UpdateFromDeltaPositionHelperISPC(MParticlesInput, Dt, Offset, FMath::Min(PBDEvolutionISPCBatchSize, NumParticles - Offset));
+					}, NonParallelUpdate);
+				}
+				else
+				{
+					PhysicsParallelFor(NumParticles, [&](int32 Index) {
+						PBDUpdateRule.Apply(MParticlesInput, Dt, Index);
+					}, NonParallelUpdate);
+				}
 			});
 }
 
@@ -128,18 +165,33 @@ void TPBDEvolution<T, d>::AdvanceOneTimeStep(const T Dt)
 		}
 	}	
 
-	// Don't bother with threaded execution if we don't have enough work to make it worth while.
-	const bool NonParallelUpdate = MParticles.Size() < 1000; // TODO: 1000 is a guess, tune this!
+	// Init force, gravity, both Euler steps and damping, plus any optional rules
+	const int32 NumPreIterationRules = 5 + MForceRules.Num() + VelocityFields.Num() + (MKinematicUpdate ? 1 : 0);
+	const bool NonParallelUpdate = PBDEvolutionShouldRunSingleThreaded(MParticles.Size(), NumPreIterationRules);
+
+	// The collision kinematic update only touches the collision particles, so it
+	// shares the pre-iteration fork/join rather than paying for its own.  Its cost
+	// is reported as part of STAT_ChaosPBDPreIterationUpdates.
+	const int32 NumParticles = (int32)MParticles.Size();
+	const int32 NumKinematicCollisionParticles = MCollisionKinematicUpdate ? (int32)MCollisionParticles.Size() : 0;
 
 	//PhysicsParallelFor(MCollisionParticles.Size(), [&](int32 Index) 
 	//{ MCollided[Index] = false; }, NonParallelUpdate);
 	//for(int32 i=0; i < MCollided.Num(); i++)
 	//	MCollided[i] = false;
-	memset(MCollided.GetData(), 0, MCollided.Num()*sizeof(bool));
+	if (MCollided.Num())
+	{
+		memset(MCollided.GetData(), 0, MCollided.Num()*sizeof(bool));
+	}
 	{
 		SCOPE_CYCLE_COUNTER(STAT_ChaosPBDPreIterationUpdates);
-		PhysicsParallelFor(MParticles.Size(), [&](int32 Index)
+		PhysicsParallelFor(NumParticles + NumKinematicCollisionParticles, [&](int32 Index)
 		{
+			if (Index >= NumParticles)
+			{
+				MCollisionKinematicUpdate(MCollisionParticles, Dt, MTime + Dt, Index - NumParticles);
+				return;
+			}
 			InitForceRule.Apply(MParticles, Dt, Index); // F = TV(0)
 			GravityForces.Apply(MParticles, Dt, Index);
 			for (TFunction<void(TPBDParticles<T, d>&, const T, const int32)>& ForceRule : MForceRules)
@@ -157,15 +209,7 @@ void TPBDEvolution<T, d>::AdvanceOneTimeStep(const T Dt)
 			EulerStepVelocityRule.Apply(MParticles, Dt, Index);
 			DampVelocityRule.Apply(MParticles, Dt, Index);
 			EulerStepRule.Apply(MParticles, Dt, Index);
-		}, NonParallelUpdate);
-	}
-
-	if (MCollisionKinematicUpdate)
-	{
-		SCOPE_CYCLE_COUNTER(STAT_CollisionKinematicUpdate);
-		PhysicsParallelFor(MCollisionParticles.Size(), [&](int32 Index) {
-			MCollisionKinematicUpdate(MCollisionParticles, Dt, MTime + Dt, Index);
-		}, NonParallelUpdate);
+		}, NonParallelUpdate && PBDEvolutionShouldRunSingleThreaded(NumKinematicCollisionParticles, 1));
 	}
 #if !COMPILE_WITHOUT_UNREAL_SUPPORT
 	TPBDCollisionSpringConstraints<T, d> SelfCollisionRule(MParticles, MCollisionTriangles, MDisabledCollisionElements, Dt, MSelfCollisionThickness, 1.5f);
@@ -208,7 +252,7 @@ void TPBDEvolution<T, d>::AdvanceOneTimeStep(const T Dt)
 		SCOPE_CYCLE_COUNTER(STAT_ChaosPBDCollisionRuleFriction);
 		PhysicsParallelFor(MParticles.Size(), [&](int32 Index) {
 			CollisionRule.ApplyFriction(MParticles, Dt, Index);
-		}, NonParallelUpdate);
+		}, PBDEvolutionShouldRunSingleThreaded(MParticles.Size(), 1));
 	}
 
 	MTime += Dt;
@@ -357,10 +357,11 @@ namespace Chaos
 			if (Ratio > MaxRatio)
 			{
 				FReal MinIMin = IMax / MaxRatio;
+				const FReal InvIRange = (FReal)1 / (IMax - IMin);
 				return FVec3(
-					FMath::Lerp(MinIMin, IMax, (InI.X - IMin) / (IMax - IMin)),
-					FMath::Lerp(MinIMin, IMax, (InI.Y - IMin) / (IMax - IMin)),
-					FMath::Lerp(MinIMin, IMax, (InI.Z - IMin) / (IMax - IMin)));
+					FMath::Lerp(MinIMin, IMax, (InI.X - IMin) * InvIRange),
+					FMath::Lerp(MinIMin, IMax, (InI.Y - IMin) * InvIRange),
+					FMath::Lerp(MinIMin, IMax, (InI.Z - IMin) * InvIRange));
 			}
 		}
 		return InI;
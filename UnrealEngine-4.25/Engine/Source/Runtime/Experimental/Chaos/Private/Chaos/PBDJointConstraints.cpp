@@ -2,10 +2,12 @@
 #include "Chaos/PBDJointConstraints.h"
 #include "Chaos/ChaosDebugDraw.h"
 #include "Chaos/DebugDrawQueue.h"
+#include "Chaos/Framework/Parallel.h"
 #include "Chaos/Joint/ChaosJointLog.h"
 #include "Chaos/Joint/PBDJointSolverGaussSeidel.h"
 #include "Chaos/Particle/ParticleUtilities.h"
 #include "Chaos/ParticleHandle.h"
+#include "Chaos/PBDConstraintColorBatches.h"
 #include "Chaos/PBDJointConstraintUtilities.h"
 #include "Chaos/Utilities.h"
 #include "ChaosLog.h"
@@ -18,12 +20,44 @@
 bool bChaos_Joint_EarlyOut_Enabled = true;
 FAutoConsoleVariableRef CVarChaosJointEarlyOutEnabled(TEXT("p.Chaos.Joint.EarlyOut"), bChaos_Joint_EarlyOut_Enabled, TEXT("Whether to iterating when joints report being solved"));
 
+bool bChaos_Joint_ParallelColor_Enabled = false;
+FAutoConsoleVariableRef CVarChaosJointParallelColorEnabled(TEXT("p.Chaos.Joint.ParallelColor"), bChaos_Joint_ParallelColor_Enabled, TEXT("Whether to color joints within each level and solve the joints of a color in parallel"));
+
+int32 Chaos_Joint_ParallelColor_MinBatchSize = 8;
+FAutoConsoleVariableRef CVarChaosJointParallelColorMinBatchSize(TEXT("p.Chaos.Joint.ParallelColorMinBatchSize"), Chaos_Joint_ParallelColor_MinBatchSize, TEXT("Minimum number of joints in a color before it is solved in parallel"));
+
+bool bChaos_Joint_SymmetricSweep_Enabled = false;
+FAutoConsoleVariableRef CVarChaosJointSymmetricSweepEnabled(TEXT("p.Chaos.Joint.SymmetricSweep"), bChaos_Joint_SymmetricSweep_Enabled, TEXT("Whether each joint Apply iteration sweeps root to leaf and then back leaf to root, so corrections travel the whole chain in both directions every iteration (ignored with p.Chaos.Joint.ParallelColor)"));
+
+int32 Chaos_Joint_ParallelPrepare_MinConstraints = 64;
+FAutoConsoleVariableRef CVarChaosJointParallelPrepareMinConstraints(TEXT("p.Chaos.Joint.ParallelPrepareMinConstraints"), Chaos_Joint_ParallelPrepare_MinConstraints, TEXT("Minimum number of joints before PrepareConstraints initializes the joint solvers in parallel (0 to disable)"));
+
 namespace Chaos
 {
 	DECLARE_CYCLE_STAT(TEXT("Joints::Sort"), STAT_Joints_Sort, STATGROUP_ChaosJoint);
 	DECLARE_CYCLE_STAT(TEXT("Joints::Apply"), STAT_Joints_Apply, STATGROUP_ChaosJoint);
 	DECLARE_CYCLE_STAT(TEXT("Joints::ApplyPushOut"), STAT_Joints_ApplyPushOut, STATGROUP_ChaosJoint);
 
+	// Solve level-ordered joints color batch by color batch, going wide within a batch. Results are summed in batch order.
+	template<typename FSolveFunction>
+	FJointSolverResult SolveJointColorBatches(const FConstraintColorBatches& Batches, const FSolveFunction& Solve)
+	{
+		TArray<FJointSolverResult> Results;
+		Results.SetNum(Batches.Order.Num());
+
+		Batches.Solve(Chaos_Joint_ParallelColor_MinBatchSize, [&](int32 OrderIndex, int32 SortedIndex)
+			{
+				Results[OrderIndex] = Solve(SortedIndex);
+			});
+
+		FJointSolverResult NetResult;
+		for (const FJointSolverResult& Result : Results)
+		{
+			NetResult += Result;
+		}
+		return NetResult;
+	}
+
 	//
 	// Constraint Handle
 	//
@@ -431,7 +465,10 @@ namespace Chaos
 	void FPBDJointConstraints::PrepareConstraints(FReal Dt)
 	{
 		ConstraintSolvers.SetNum(NumConstraints());
-		for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
+
+		// Each solver bakes its own joint constants from read-only particle state, so they can be initialized in any order
+		const bool bPrepareSingleThreaded = (Chaos_Joint_ParallelPrepare_MinConstraints <= 0) || (NumConstraints() < Chaos_Joint_ParallelPrepare_MinConstraints);
+		PhysicsParallelFor(NumConstraints(), [&](int32 ConstraintIndex)
 		{
 			const FPBDJointSettings& JointSettings = ConstraintSettings[ConstraintIndex];
 			const FTransformPair& JointFrames = ConstraintFrames[ConstraintIndex];
@@ -456,7 +493,7 @@ namespace Chaos
 				Particle1->InvI().GetDiagonal(),
 				FParticleUtilities::ParticleLocalToCoMLocal(Particle0, JointFrames[Index0]),
 				FParticleUtilities::ParticleLocalToCoMLocal(Particle1, JointFrames[Index1]));
-		}
+		}, bPrepareSingleThreaded);
 	}
 
 
@@ -503,9 +540,31 @@ namespace Chaos
 		FJointSolverResult NetResult;
 		if (Settings.ApplyPairIterations > 0)
 		{
-			for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
+			if (bChaos_Joint_ParallelColor_Enabled)
+			{
+				const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, ConstraintParticles.GetData(), NumConstraints(), It,
+					[this](int32 SortedIndex) { return ConstraintStates[SortedIndex].Level; },
+					[this](int32 SortedIndex) -> const TVector<TGeometryParticleHandle<FReal, 3>*, 2>& { return ConstraintParticles[SortedIndex]; });
+				NetResult = SolveJointColorBatches(Batches, [&](int32 ConstraintIndex)
+					{
+						return SolvePosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPairIterations, It, NumIts);
+					});
+			}
+			else
 			{
-				NetResult += SolvePosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPairIterations, It, NumIts);
+				for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
+				{
+					NetResult += SolvePosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPairIterations, It, NumIts);
+				}
+
+				// Return sweep so leaf corrections reach the root in the same iteration. The last joint was just solved so skip it.
+				if (bChaos_Joint_SymmetricSweep_Enabled)
+				{
+					for (int32 ConstraintIndex = NumConstraints() - 2; ConstraintIndex >= 0; --ConstraintIndex)
+					{
+						NetResult += SolvePosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPairIterations, It, NumIts);
+					}
+				}
 			}
 		}
 
@@ -526,9 +585,22 @@ namespace Chaos
 		FJointSolverResult NetResult;
 		if (Settings.ApplyPushOutPairIterations > 0)
 		{
-			for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
+			if (bChaos_Joint_ParallelColor_Enabled)
 			{
-				NetResult += ProjectPosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPushOutPairIterations, It, NumIts);
+				const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, ConstraintParticles.GetData(), NumConstraints(), It,
+					[this](int32 SortedIndex) { return ConstraintStates[SortedIndex].Level; },
+					[this](int32 SortedIndex) -> const TVector<TGeometryParticleHandle<FReal, 3>*, 2>& { return ConstraintParticles[SortedIndex]; });
+				NetResult = SolveJointColorBatches(Batches, [&](int32 ConstraintIndex)
+					{
+						return ProjectPosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPushOutPairIterations, It, NumIts);
+					});
+			}
+			else
+			{
+				for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
+				{
+					NetResult += ProjectPosition_GaussSiedel(Dt, ConstraintIndex, Settings.ApplyPushOutPairIterations, It, NumIts);
+				}
 			}
 		}
 
@@ -580,9 +652,32 @@ namespace Chaos
 		FJointSolverResult NetResult;
 		if (Settings.ApplyPairIterations > 0)
 		{
-			for (FConstraintContainerHandle* ConstraintHandle : SortedConstraintHandles)
+			if (bChaos_Joint_ParallelColor_Enabled)
+			{
+				// Keyed on the island's own handle list, the sorted copy is rebuilt identically every call
+				const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, InConstraintHandles.GetData(), SortedConstraintHandles.Num(), It,
+					[&SortedConstraintHandles](int32 SortedIndex) { return SortedConstraintHandles[SortedIndex]->GetConstraintLevel(); },
+					[this, &SortedConstraintHandles](int32 SortedIndex) -> const TVector<TGeometryParticleHandle<FReal, 3>*, 2>& { return ConstraintParticles[SortedConstraintHandles[SortedIndex]->GetConstraintIndex()]; });
+				NetResult = SolveJointColorBatches(Batches, [&](int32 SortedIndex)
+					{
+						return SolvePosition_GaussSiedel(Dt, SortedConstraintHandles[SortedIndex]->GetConstraintIndex(), Settings.ApplyPairIterations, It, NumIts);
+					});
+			}
+			else
 			{
-				NetResult += SolvePosition_GaussSiedel(Dt, ConstraintHandle->GetConstraintIndex(), Settings.ApplyPairIterations, It, NumIts);
+				for (FConstraintContainerHandle* ConstraintHandle : SortedConstraintHandles)
+				{
+					NetResult += SolvePosition_GaussSiedel(Dt, ConstraintHandle->GetConstraintIndex(), Settings.ApplyPairIterations, It, NumIts);
+				}
+
+				// Return sweep so leaf corrections reach the root in the same iteration. The last joint was just solved so skip it.
+				if (bChaos_Joint_SymmetricSweep_Enabled)
+				{
+					for (int32 SortedIndex = SortedConstraintHandles.Num() - 2; SortedIndex >= 0; --SortedIndex)
+					{
+						NetResult += SolvePosition_GaussSiedel(Dt, SortedConstraintHandles[SortedIndex]->GetConstraintIndex(), Settings.ApplyPairIterations, It, NumIts);
+					}
+				}
 			}
 		}
 
@@ -609,9 +704,23 @@ namespace Chaos
 		FJointSolverResult NetResult;
 		if (Settings.ApplyPushOutPairIterations > 0)
 		{
-			for (FConstraintContainerHandle* ConstraintHandle : SortedConstraintHandles)
+			if (bChaos_Joint_ParallelColor_Enabled)
+			{
+				// Keyed on the island's own handle list, the sorted copy is rebuilt identically every call
+				const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, InConstraintHandles.GetData(), SortedConstraintHandles.Num(), It,
+					[&SortedConstraintHandles](int32 SortedIndex) { return SortedConstraintHandles[SortedIndex]->GetConstraintLevel(); },
+					[this, &SortedConstraintHandles](int32 SortedIndex) -> const TVector<TGeometryParticleHandle<FReal, 3>*, 2>& { return ConstraintParticles[SortedConstraintHandles[SortedIndex]->GetConstraintIndex()]; });
+				NetResult = SolveJointColorBatches(Batches, [&](int32 SortedIndex)
+					{
+						return ProjectPosition_GaussSiedel(Dt, SortedConstraintHandles[SortedIndex]->GetConstraintIndex(), Settings.ApplyPushOutPairIterations, It, NumIts);
+					});
+			}
+			else
 			{
-				NetResult += ProjectPosition_GaussSiedel(Dt, ConstraintHandle->GetConstraintIndex(), Settings.ApplyPushOutPairIterations, It, NumIts);
+				for (FConstraintContainerHandle* ConstraintHandle : SortedConstraintHandles)
+				{
+					NetResult += ProjectPosition_GaussSiedel(Dt, ConstraintHandle->GetConstraintIndex(), Settings.ApplyPushOutPairIterations, It, NumIts);
+				}
 			}
 		}
 
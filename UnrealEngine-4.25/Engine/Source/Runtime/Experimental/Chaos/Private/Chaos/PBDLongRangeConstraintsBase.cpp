@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 #include "Chaos/PBDLongRangeConstraintsBase.h"
 
+#include "Algo/Reverse.h"
 #include "Chaos/Map.h"
 #include "Chaos/Vector.h"
 #include "Chaos/Framework/Parallel.h"
@@ -207,70 +208,115 @@ void TPBDLongRangeConstraintsBase<T, d>::ComputeGeodesicConstraints(
 		}
 	}
 	TArray<TArray<uint32>> IslandElements = ComputeIslands(InParticles, PointToNeighbors, KinematicParticles);
-	// Store distances for all adjacent vertices
-	TMap<TVector<uint32, 2>, T> Distances;
-	for (const uint32 i : UsedIndices)
+
+	// Compact the mesh adjacency into CSR form over dense local indices, with
+	// the edge lengths stored alongside, so the searches below don't need to
+	// hash particle pairs.
+	const int32 NumUsed = UsedIndices.Num();
+	TArray<int32> ParticleToLocal;
+	ParticleToLocal.Init(INDEX_NONE, (int32)InParticles.Size());
+	for (int32 LocalIndex = 0; LocalIndex < NumUsed; ++LocalIndex)
 	{
-		auto Neighbors = PointToNeighbors[i];
-		for (auto Neighbor : Neighbors)
-		{
-			Distances.Add(TVector<uint32, 2>(i, Neighbor), ComputeDistance(InParticles, Neighbor, i));
-		}
+		ParticleToLocal[UsedIndices[LocalIndex]] = LocalIndex;
 	}
-	// Start and End Points to path and geodesic distance
-	TMap<TVector<uint32, 2>, Pair<T, TArray<uint32>>> GeodesicPaths;
-	// Dijkstra for each Kinematic Particle (assume a small number of kinematic points) - note this is N^2 log N with N kinematic points
-	for (const uint32 Element : KinematicParticles)
+	TArray<int32> NeighborOffsets;
+	NeighborOffsets.SetNumUninitialized(NumUsed + 1);
+	NeighborOffsets[0] = 0;
+	for (int32 LocalIndex = 0; LocalIndex < NumUsed; ++LocalIndex)
 	{
-		GeodesicPaths.Add(TVector<uint32, 2>(Element, Element), {0, {Element}});
-		for (const uint32 i : UsedIndices)
+		NeighborOffsets[LocalIndex + 1] = NeighborOffsets[LocalIndex] + PointToNeighbors[UsedIndices[LocalIndex]].Num();
+	}
+	TArray<uint32> NeighborParticles;
+	NeighborParticles.SetNumUninitialized(NeighborOffsets[NumUsed]);
+	TArray<T> NeighborDistances;
+	NeighborDistances.SetNumUninitialized(NeighborOffsets[NumUsed]);
+	for (int32 LocalIndex = 0; LocalIndex < NumUsed; ++LocalIndex)
+	{
+		const uint32 i = UsedIndices[LocalIndex];
+		int32 Offset = NeighborOffsets[LocalIndex];
+		for (const uint32 Neighbor : PointToNeighbors[i])
 		{
-			if (i != Element)
-			{
-				GeodesicPaths.Add(TVector<uint32, 2>(Element, i), {FLT_MAX, {}});
-			}
+			NeighborParticles[Offset] = Neighbor;
+			NeighborDistances[Offset] = ComputeDistance(InParticles, Neighbor, i);
+			++Offset;
 		}
 	}
-	PhysicsParallelFor(KinematicParticles.Num(), [&](int32 Index)
+
+	// Geodesic distance and predecessor on the shortest path, per kinematic
+	// source and local index.  Paths are rebuilt from the predecessors only
+	// for the constraints that are kept, rather than copied on every relaxation.
+	const int32 NumKinematic = KinematicParticles.Num();
+	TArray<T> GeodesicDistances;
+	GeodesicDistances.Init(FLT_MAX, NumKinematic * NumUsed);
+	TArray<int32> GeodesicPredecessors;
+	GeodesicPredecessors.Init(INDEX_NONE, NumKinematic * NumUsed);
+	TArray<int32> KinematicToSource;
+	KinematicToSource.Init(INDEX_NONE, (int32)InParticles.Size());
+	for (int32 Source = 0; Source < NumKinematic; ++Source)
+	{
+		KinematicToSource[KinematicParticles[Source]] = Source;
+	}
+
+	// Dijkstra for each Kinematic Particle (assume a small number of kinematic points) - note this is N^2 log N with N kinematic points
+	PhysicsParallelFor(NumKinematic, [&](int32 Index)
 	{
 		const uint32 Element = KinematicParticles[Index];
+		T* const Dists = &GeodesicDistances[Index * NumUsed];
+		int32* const Predecessors = &GeodesicPredecessors[Index * NumUsed];
+		Dists[ParticleToLocal[Element]] = (T)0.;
+
 		std::priority_queue<Pair<T, uint32>, std::vector<Pair<T, uint32>>, std::greater<Pair<T, uint32>>> q;  // TODO(Kriss.Gossart): Remove use of std container
 		q.push(MakePair((T)0., Element));
-		TSet<uint32> Visited;
+		TBitArray<> Visited(false, NumUsed);
 		while (!q.empty())
 		{
 			const Pair<T, uint32> PairElem = q.top();
 			q.pop();
-			if (Visited.Contains(PairElem.Second))
+			const int32 Current = ParticleToLocal[PairElem.Second];
+			if (Visited[Current])
 				continue;
-			Visited.Add(PairElem.Second);
-			const TVector<uint32, 2> CurrentStartEnd(Element, PairElem.Second);
-			const TSet<uint32>& Neighbors = PointToNeighbors[PairElem.Second];
-			for (const uint32 Neighbor : Neighbors)
+			Visited[Current] = true;
+			for (int32 NeighborIndex = NeighborOffsets[Current]; NeighborIndex < NeighborOffsets[Current + 1]; ++NeighborIndex)
 			{
+				const uint32 Neighbor = NeighborParticles[NeighborIndex];
 				if (InParticles.InvM(Neighbor) == (T)0.) { continue; }
 				check(Neighbor != PairElem.Second);
-				const TVector<uint32, 2> NeighborStartEnd(Element, Neighbor);
-				const Pair<T, TArray<uint32>>& NeighborDistancePath = GeodesicPaths[NeighborStartEnd];
-				// Compute a possible distance for NeighborStartEnd
-				const T NewDist = PairElem.First + Distances[TVector<uint32, 2>(PairElem.Second, Neighbor)];
-				if (NewDist < NeighborDistancePath.First)
+				const int32 NeighborLocal = ParticleToLocal[Neighbor];
+				check(NeighborLocal != INDEX_NONE);
+				// Compute a possible distance for the neighbor
+				const T NewDist = PairElem.First + NeighborDistances[NeighborIndex];
+				if (NewDist < Dists[NeighborLocal])
 				{
-					TArray<uint32> NewPath = GeodesicPaths[CurrentStartEnd].Second;
-					check(NewPath.Num() > 0 && NewPath[NewPath.Num() - 1] != Neighbor);
-					NewPath.Add(Neighbor);
-					GeodesicPaths[NeighborStartEnd] = {NewDist, NewPath};
-					q.push(MakePair(GeodesicPaths[NeighborStartEnd].First, Neighbor));
+					Dists[NeighborLocal] = NewDist;
+					Predecessors[NeighborLocal] = Current;
+					q.push(MakePair(NewDist, Neighbor));
 				}
 			}
 		}
 	});
-	FCriticalSection CriticalSection;
-	PhysicsParallelFor(UsedIndices.Num(), [&](uint32 UsedIndex) {
+
+	// Rebuild the path from a kinematic source to a particle, source first.
+	auto GetGeodesicPath = [&](const int32 Source, const int32 EndLocal)
+	{
+		const int32* const Predecessors = &GeodesicPredecessors[Source * NumUsed];
+		TArray<uint32> Path;
+		for (int32 Local = EndLocal; Local != INDEX_NONE; Local = Predecessors[Local])
+		{
+			Path.Add(UsedIndices[Local]);
+		}
+		Algo::Reverse(Path);
+		return Path;
+	};
+
+	// Each dynamic particle writes its own slot, so the paths can be gathered
+	// in a deterministic order without locking.
+	TArray<TArray<Pair<T, int32>>> ClosestElementsPerParticle;
+	ClosestElementsPerParticle.SetNum(NumUsed);
+	PhysicsParallelFor(NumUsed, [&](int32 UsedIndex) {
 		const uint32 i = UsedIndices[UsedIndex];
 		if (InParticles.InvM(i) == 0)
 			return;
-		TArray<Pair<T, int32>> ClosestElements;
+		TArray<Pair<T, int32>>& ClosestElements = ClosestElementsPerParticle[UsedIndex];
 		for (const TArray<uint32>& Elements : IslandElements)
 		{
 			if (!Elements.Num()) { continue; }  // Empty island 
@@ -280,7 +326,7 @@ void TPBDLongRangeConstraintsBase<T, d>::ComputeGeodesicConstraints(
 
 			for (const uint32 Element : Elements)
 			{
-				const T Distance = GeodesicPaths[TVector<uint32, 2>(Element, i)].First;
+				const T Distance = GeodesicDistances[KinematicToSource[Element] * NumUsed + UsedIndex];
 				if (Distance < ClosestDistance)
 				{
 					ClosestDistance = Distance;
@@ -289,9 +335,7 @@ void TPBDLongRangeConstraintsBase<T, d>::ComputeGeodesicConstraints(
 			}
 			if (ClosestElement == INDEX_NONE) { continue; }  // Not on this island
 
-			const TVector<uint32, 2> Index(ClosestElement, i);
-			check(GeodesicPaths[Index].First != FLT_MAX);
-			check(GeodesicPaths[Index].Second.Num() > 1);
+			check(GeodesicPredecessors[KinematicToSource[ClosestElement] * NumUsed + UsedIndex] != INDEX_NONE);
 			ClosestElements.Add(MakePair(ClosestDistance, ClosestElement));
 		}
 		// How to sort based on smalled first value of pair....
@@ -300,17 +344,20 @@ void TPBDLongRangeConstraintsBase<T, d>::ComputeGeodesicConstraints(
 		{
 			ClosestElements.SetNum(NumberOfAttachments);
 		}
-		for (const Pair<T, int32>& Element : ClosestElements)
+	});
+	for (int32 UsedIndex = 0; UsedIndex < NumUsed; ++UsedIndex)
+	{
+		for (const Pair<T, int32>& Element : ClosestElementsPerParticle[UsedIndex])
 		{
-			const TVector<uint32, 2> Index(Element.Second, i);
-			check(GeodesicPaths[Index].First == Element.First);
-			check(FGenericPlatformMath::Abs(Element.First - ComputeGeodesicDistance(InParticles, GeodesicPaths[Index].Second)) < 1e-4);
-			CriticalSection.Lock();
-			MConstraints.Add(GeodesicPaths[Index].Second);
+			const int32 Source = KinematicToSource[Element.Second];
+			check(GeodesicDistances[Source * NumUsed + UsedIndex] == Element.First);
+			TArray<uint32> Path = GetGeodesicPath(Source, UsedIndex);
+			check(Path.Num() > 1 && Path[0] == (uint32)Element.Second);
+			check(FGenericPlatformMath::Abs(Element.First - ComputeGeodesicDistance(InParticles, Path)) < 1e-4);
+			MConstraints.Add(MoveTemp(Path));
 			MDists.Add(Element.First);
-			CriticalSection.Unlock();
 		}
-	});
+	}
 	// TODO(mlentine): This should work by just reverse sorting and not needing the filtering but it may not be guaranteed. Work out if this is actually guaranteed or not.
 	MConstraints.Sort([](const TArray<uint32>& Elem1, const TArray<uint32>& Elem2) { return Elem1.Num() > Elem2.Num(); });
 	TArray<TArray<uint32>> NewConstraints;
@@ -3,6 +3,7 @@
 #include "Chaos/PBDRigidClustering.h"
 
 #include "Chaos/ErrorReporter.h"
+#include "Chaos/Framework/Parallel.h"
 #include "Chaos/ImplicitObjectTransformed.h"
 #include "Chaos/ImplicitObjectUnion.h"
 #include "Chaos/Levelset.h"
@@ -13,7 +14,6 @@
 #include "Chaos/Sphere.h"
 #include "Chaos/UniformGrid.h"
 #include "ChaosStats.h"
-#include "Containers/Queue.h"
 #include "ProfilingDebugging/ScopedTimers.h"
 #include "Voronoi/Voronoi.h"
 #include "Chaos/PBDRigidsEvolutionGBF.h"
@@ -73,6 +73,9 @@ namespace Chaos
 	int32 MassPropertiesFromMultiChildProxy = 1;
 	FAutoConsoleVariableRef CVarMassPropertiesFromMultiChildProxy(TEXT("p.MassPropertiesFromMultiChildProxy"), MassPropertiesFromMultiChildProxy, TEXT(""));
 
+	int32 ClusterParallelBreakMinClusters = 64;
+	FAutoConsoleVariableRef CVarClusterParallelBreakMinClusters(TEXT("p.ClusterParallelBreakMinClusters"), ClusterParallelBreakMinClusters, TEXT("Minimum number of clusters before strain checks in AdvanceClustering and BreakingModel run in parallel (0 to disable)"));
+
 	//==========================================================================
 	// Free helper functions
 	//==========================================================================
@@ -250,8 +253,9 @@ namespace Chaos
 			}
 
 			const T ChildMass = Child->M();
+			const FMatrix ChildRotationMatrix = ChildRotation.ToMatrix();
 			const PMatrix<T, d, d> ChildWorldSpaceI = 
-				(ChildRotation * FMatrix::Identity) * Child->I() * (ChildRotation * FMatrix::Identity).GetTransposed();
+				ChildRotationMatrix * Child->I() * ChildRotationMatrix.GetTransposed();
 			if (ChildWorldSpaceI.ContainsNaN())
 			{
 				continue;
@@ -274,8 +278,9 @@ namespace Chaos
 				const TRotation<T, d>& ChildRotation = Child->R();
 				const T ChildMass = Child->M();
 
+				const FMatrix ChildRotationMatrix = ChildRotation.ToMatrix();
 				const PMatrix<T, d, d> ChildWorldSpaceI = 
-					(ChildRotation * FMatrix::Identity) * Child->I() * (ChildRotation * FMatrix::Identity).GetTransposed();
+					ChildRotationMatrix * Child->I() * ChildRotationMatrix.GetTransposed();
 				if (ChildWorldSpaceI.ContainsNaN())
 				{
 					continue;
@@ -608,21 +613,22 @@ namespace Chaos
 			for (TTuple<int32, TArray<TPBDRigidClusteredParticleHandle<T, 3>* >>& Group : ClusterUnionMap)
 			{
 				int32 ClusterGroupID = Group.Key;
-				TArray<TPBDRigidClusteredParticleHandle<T, 3>* > Handles = Group.Value;
+				const TArray<TPBDRigidClusteredParticleHandle<T, 3>* >& Handles = Group.Value;
 
 				if (Handles.Num() > 1)
 				{
-					if (!NewClusterGroups.Contains(ClusterGroupID))
-						NewClusterGroups.Add(ClusterGroupID, TArray < TPBDRigidParticleHandle<T, 3>*>());
-
-					TArray<TPBDRigidParticleHandle<T, 3>*> ClusterBodies;
+					TArray<TPBDRigidParticleHandle<T, 3>*>& NewClusterGroup = NewClusterGroups.FindOrAdd(ClusterGroupID);
 					for (TPBDRigidClusteredParticleHandle<T, 3>* ActiveCluster : Handles)
 					{
 						if (!ActiveCluster->Disabled())
 						{
 							TSet<TPBDRigidParticleHandle<T, 3>*> Children = ReleaseClusterParticles(ActiveCluster, nullptr, true);
-							NewClusterGroups[ClusterGroupID].Append(Children.Array());
-							for (auto& Child : Children) ClusterParents.Add(Child, ActiveCluster);
+							NewClusterGroup.Reserve(NewClusterGroup.Num() + Children.Num());
+							for (TPBDRigidParticleHandle<T, 3>* Child : Children)
+							{
+								NewClusterGroup.Add(Child);
+								ClusterParents.Add(Child, ActiveCluster);
+							}
 						}
 					}
 				}
@@ -650,13 +656,12 @@ namespace Chaos
 	{
 		SCOPE_CYCLE_COUNTER(STAT_DeactivateClusterParticle);
 
-		TSet<TPBDRigidParticleHandle<T, d>*> ActivatedChildren;
 		check(!ClusteredParticle->Disabled());
-		if (MChildren.Contains(ClusteredParticle))
+		if (const TArray<TPBDRigidParticleHandle<T, d>*>* Children = MChildren.Find(ClusteredParticle))
 		{
-			ActivatedChildren = ReleaseClusterParticles(MChildren[ClusteredParticle]);
+			return ReleaseClusterParticles(*Children);
 		}
-		return ActivatedChildren;
+		return TSet<TPBDRigidParticleHandle<T, d>*>();
 	}
 
 	DECLARE_CYCLE_STAT(TEXT("TPBDRigidClustering<>::ReleaseClusterParticles(STRAIN)"), STAT_ReleaseClusterParticles_STRAIN, STATGROUP_Chaos);
@@ -675,6 +680,7 @@ namespace Chaos
 			return ActivatedChildren;
 		}
 		TArray<TPBDRigidParticleHandle<T, d>*>& Children = MChildren[ClusteredParticle];
+		ActivatedChildren.Reserve(Children.Num());
 
 		bool bChildrenChanged = false;
 		const bool bRewindOnDecluster = ChaosClusteringChildrenInheritVelocity < 1;
@@ -810,6 +816,9 @@ namespace Chaos
 						TSet<TPBDRigidParticleHandle<T, d>*> ProcessedChildren;
 						ProcessedChildren.Reserve(Children.Num());
 
+						// Shared by every piece; Pop keeps the allocation so the traversal doesn't reallocate per piece
+						TArray<TPBDRigidParticleHandle<T, d>*, TInlineAllocator<64>> ProcessingQueue;
+
 						for (TPBDRigidParticleHandle<T, d>* PotentialActivatedChild : Children)
 						{
 							if (ProcessedChildren.Contains(PotentialActivatedChild))
@@ -819,14 +828,14 @@ namespace Chaos
 							ConnectedPiecesArray.AddDefaulted();
 							TArray<TPBDRigidParticleHandle<T, d>*>& ConnectedPieces = ConnectedPiecesArray.Last();
 
-							TArray<TPBDRigidParticleHandle<T, d>*> ProcessingQueue;
 							ProcessingQueue.Add(PotentialActivatedChild);
 							while (ProcessingQueue.Num())
 							{
-								TPBDRigidParticleHandle<T, d>* Child = ProcessingQueue.Pop();
-								if (!ProcessedChildren.Contains(Child))
+								TPBDRigidParticleHandle<T, d>* Child = ProcessingQueue.Pop(/*bAllowShrinking=*/false);
+								bool bAlreadyProcessed = false;
+								ProcessedChildren.Add(Child, &bAlreadyProcessed);
+								if (!bAlreadyProcessed)
 								{
-									ProcessedChildren.Add(Child);
 									ConnectedPieces.Add(Child);
 									for (const TConnectivityEdge<T>& Edge : Child->CastToClustered()->ConnectivityEdges())
 									{
@@ -911,6 +920,7 @@ namespace Chaos
 			//todo(ocohen): refactor incoming, for now just assume these all belong to same cluster and hack strain array
 			
 			TMap<TGeometryParticleHandle<T, d>*, float> FakeStrain;
+			FakeStrain.Reserve(ChildrenParticles.Num());
 
 			bool bPreDoGenerateData = DoGenerateBreakingData;
 			DoGenerateBreakingData = false;
@@ -995,23 +1005,35 @@ namespace Chaos
 			{
 				SCOPE_CYCLE_COUNTER(STAT_UpdateDirtyImpulses);
 				const auto& ActiveClusteredArray = MEvolution.GetActiveClusteredArray();
-				for (const auto& ActiveCluster : ActiveClusteredArray)
-				{
-					if (ActiveCluster->ClusterIds().NumChildren > 0) //active index is a cluster
+				const int32 NumActiveClusters = ActiveClusteredArray.Num();
+
+				// A child belongs to one parent, so clusters can be processed in parallel. Record per cluster whether
+				// anything was marked rather than writing the shared dirty flag from every task.
+				TArray<bool> ClusterIsDirty;
+				ClusterIsDirty.SetNumZeroed(NumActiveClusters);
+				PhysicsParallelFor(NumActiveClusters, [&](int32 ClusterIndex)
 					{
-						TArray<TPBDRigidParticleHandle<T, d>*>& ParentToChildren = MChildren[ActiveCluster];
-						for (TPBDRigidParticleHandle<T, d>* Child : ParentToChildren)
+						const auto& ActiveCluster = ActiveClusteredArray[ClusterIndex];
+						if (ActiveCluster->ClusterIds().NumChildren > 0) //active index is a cluster
 						{
-							if (TPBDRigidClusteredParticleHandle<T, d>* ClusteredChild = Child->CastToClustered())
+							TArray<TPBDRigidParticleHandle<T, d>*>& ParentToChildren = MChildren[ActiveCluster];
+							for (TPBDRigidParticleHandle<T, d>* Child : ParentToChildren)
 							{
-								if (ClusteredChild->Strain() <= 0.f)
+								if (TPBDRigidClusteredParticleHandle<T, d>* ClusteredChild = Child->CastToClustered())
 								{
-									ClusteredChild->CollisionImpulse() = FLT_MAX;
-									MCollisionImpulseArrayDirty = true;
+									if (ClusteredChild->Strain() <= 0.f)
+									{
+										ClusteredChild->CollisionImpulse() = FLT_MAX;
+										ClusterIsDirty[ClusterIndex] = true;
+									}
 								}
 							}
 						}
-					}
+					}, NumActiveClusters < ClusterParallelBreakMinClusters);
+
+				if (ClusterIsDirty.Contains(true))
+				{
+					MCollisionImpulseArrayDirty = true;
 				}
 			}
 
@@ -1024,7 +1046,7 @@ namespace Chaos
 
 				TSet<TPBDRigidParticleHandle<T, d>*> AllActivatedChildren;
 				TSet<int32> IslandsToRecollide;
-				for (auto Itr : ClusterToActivatedChildren)
+				for (auto& Itr : ClusterToActivatedChildren)
 				{
 					//question: do we need to iterate all the children? Seems like island is known from cluster, but don't want to break anything at this point
 					TSet<TPBDRigidParticleHandle<T, d>*>& ActivatedChildren = Itr.Value;
@@ -1033,7 +1055,7 @@ namespace Chaos
 						if (ensure(!ActiveChild->Disabled()))
 						{
 							int32 Island = ActiveChild->Island();
-							if (!IslandsToRecollide.Contains(Island) && Island != INDEX_NONE) // todo ask mike
+							if (Island != INDEX_NONE) // todo ask mike
 							{
 								IslandsToRecollide.Add(Island);
 							}
@@ -1054,7 +1076,7 @@ namespace Chaos
 
 					if (ChaosClusteringChildrenInheritVelocity > 0.f)
 					{
-						for (auto Itr : ClusterToActivatedChildren)
+						for (auto& Itr : ClusterToActivatedChildren)
 						{
 							TPBDRigidClusteredParticleHandle<T, d>* ClusteredParticle = Itr.Key;
 							TSet<TPBDRigidParticleHandle<T, d>*>& ActivatedChildren = Itr.Value;
@@ -1085,13 +1107,59 @@ namespace Chaos
 		TMap<TPBDRigidClusteredParticleHandle<T,d>*, TSet<TPBDRigidParticleHandle<T, d>*>> AllActivatedChildren;
 
 		auto NonDisabledClusteredParticles = MEvolution.GetNonDisabledClusteredArray(); //make copy because release cluster modifies active indices. We want to iterate over original active indices
-		for (auto ClusteredParticle : NonDisabledClusteredParticles)
+		const int32 NumClusters = NonDisabledClusteredParticles.Num();
+
+		// Most clusters have no child over its strain limit. Find the ones that do in a read-only parallel pass
+		// so the serial pass below only releases those, in the original order.
+		TArray<bool> ClusterMayBreak;
+		ClusterMayBreak.SetNumZeroed(NumClusters);
+		PhysicsParallelFor(NumClusters, [&](int32 ClusterIndex)
+			{
+				const auto ClusteredParticle = NonDisabledClusteredParticles[ClusterIndex];
+				if (!ClusteredParticle->ClusterIds().NumChildren)
+				{
+					return;
+				}
+
+				const TArray<TPBDRigidParticleHandle<T, d>*>* Children = MChildren.Find(ClusteredParticle);
+				if (!Children)
+				{
+					// Let ReleaseClusterParticles report the missing cluster
+					ClusterMayBreak[ClusterIndex] = true;
+					return;
+				}
+
+				for (TPBDRigidParticleHandle<T, d>* Child : *Children)
+				{
+					if (const TPBDRigidClusteredParticleHandle<T, d>* ClusteredChild = Child->CastToClustered())
+					{
+						const float* MapStrain = ExternalStrainMap ? ExternalStrainMap->Find(Child) : nullptr;
+						const Chaos::FReal ChildStrain = MapStrain ? *MapStrain : ClusteredChild->CollisionImpulses();
+						if (ChildStrain >= ClusteredChild->Strain())
+						{
+							ClusterMayBreak[ClusterIndex] = true;
+							return;
+						}
+					}
+				}
+			}, NumClusters < ClusterParallelBreakMinClusters);
+
+		for (int32 ClusterIndex = 0; ClusterIndex < NumClusters; ++ClusterIndex)
 		{
+			auto ClusteredParticle = NonDisabledClusteredParticles[ClusterIndex];
 			if (ClusteredParticle->ClusterIds().NumChildren)
 			{
-				AllActivatedChildren.Add(
-					ClusteredParticle, 
-					ReleaseClusterParticles(ClusteredParticle, ExternalStrainMap));
+				if (ClusterMayBreak[ClusterIndex])
+				{
+					AllActivatedChildren.Add(
+						ClusteredParticle,
+						ReleaseClusterParticles(ClusteredParticle, ExternalStrainMap));
+				}
+				else
+				{
+					// Nothing to release, but callers still get an (empty) entry for every cluster with children
+					AllActivatedChildren.Add(ClusteredParticle, TSet<TPBDRigidParticleHandle<T, d>*>());
+				}
 			}
 			else
 			{
@@ -1155,26 +1223,23 @@ namespace Chaos
 
 		EObjectStateType ObjectState = EObjectStateType::Dynamic;
 		check(Parent != nullptr);
-		if (MChildren.Contains(Parent) && MChildren[Parent].Num())
+		const TArray<Chaos::TPBDRigidParticleHandle<float, 3>*>* ParentChildren = MChildren.Find(Parent);
+		if (ParentChildren && ParentChildren->Num())
 		{
-			// TQueue is a linked list, which has no preallocator.
-			TQueue<Chaos::TPBDRigidParticleHandle<float, 3>*> Queue;
-			for (Chaos::TPBDRigidParticleHandle<float, 3>* Child : MChildren[Parent])
-			{
-				Queue.Enqueue(Child);
-			}
+			// Breadth first, the first non-dynamic descendant visited decides the state. The queue is an
+			// inline array with a read cursor rather than a TQueue, which allocates a node per entry.
+			TArray<Chaos::TPBDRigidParticleHandle<float, 3>*, TInlineAllocator<64>> Queue;
+			Queue.Append(*ParentChildren);
 
-			Chaos::TPBDRigidParticleHandle<float, 3>* CurrentHandle;
-			while (Queue.Dequeue(CurrentHandle) && ObjectState == EObjectStateType::Dynamic)
+			for (int32 Head = 0; Head < Queue.Num() && ObjectState == EObjectStateType::Dynamic; ++Head)
 			{
+				Chaos::TPBDRigidParticleHandle<float, 3>* CurrentHandle = Queue[Head];
+
 				// @question : Maybe we should just store the leaf node bodies in a
 				// map, that will require Memory(n*log(n))
-				if (MChildren.Contains(CurrentHandle))
+				if (const TArray<Chaos::TPBDRigidParticleHandle<float, 3>*>* CurrentChildren = MChildren.Find(CurrentHandle))
 				{
-					for (Chaos::TPBDRigidParticleHandle<float, 3>* Child : MChildren[CurrentHandle])
-					{
-						Queue.Enqueue(Child);
-					}
+					Queue.Append(*CurrentChildren);
 				}
 
 				const EObjectStateType CurrState = CurrentHandle->ObjectState();
@@ -1727,6 +1792,8 @@ namespace Chaos
 
 		const T Delta = FMath::Min(FMath::Max(Parameters.CoillisionThicknessPercent, (T)0), T(1));
 		const TArray<TPBDRigidParticleHandle<T, d>*>& Children = MChildren[Parent];
+		TArray<bool> Connected; // Reused for every child; entry Idx is set when Children[i + 1 + Idx] touches Children[i]
+		Connected.Reserve(Children.Num());
 		for (int32 i = 0; i < Children.Num(); ++i)
 		{
 			TPBDRigidParticleHandle<T, d>* Child1 = Children[i];
@@ -1744,10 +1811,8 @@ namespace Chaos
 
 			const int32 Offset = i + 1;
 			const int32 NumRemainingChildren = Children.Num() - Offset;
-			typedef TPair<TPBDRigidParticleHandle<T, d>*, TPBDRigidParticleHandle<T, d>*> ParticlePair;
-			typedef TArray<ParticlePair> ParticlePairArray;
-			TArray<ParticlePairArray> Connections;
-			Connections.Init(ParticlePairArray(), NumRemainingChildren);
+			Connected.Reset();
+			Connected.SetNumZeroed(NumRemainingChildren);
 			PhysicsParallelFor(NumRemainingChildren, [&](int32 Idx) 
 			{
 				const int32 ChildrenIdx = Offset + Idx;
@@ -1770,18 +1835,15 @@ namespace Chaos
 					if (Phi < 0.0)
 						bCollided = true;
 				}
-				if (bCollided)
-				{
-					Connections[Idx].Add(ParticlePair(Child1, Child2));
-				}
+				Connected[Idx] = bCollided;
 			});
 
-			// join results and make connections
-			for (const ParticlePairArray& ConnectionList : Connections)
+			// join results in child order and make connections
+			for (int32 Idx = 0; Idx < NumRemainingChildren; ++Idx)
 			{
-				for (const ParticlePair& Edge : ConnectionList)
+				if (Connected[Idx])
 				{
-					ConnectNodes(Edge.Key, Edge.Value);
+					ConnectNodes(Child1, Children[Offset + Idx]);
 				}
 			}
 		}
@@ -1962,22 +2024,44 @@ namespace Chaos
 		TArray<TArray<int>> Neighbors;
 		VoronoiNeighbors(Pts, Neighbors);
 
-		TSet<TPair<TPBDRigidParticleHandle<T, d>*, TPBDRigidParticleHandle<T, d>*>> UniqueEdges;
+		// Neighbors is an index adjacency list, so each edge is visited from its lower index only: (i, j) is
+		// taken when i < j, or when i > j and j does not list i. This replaces a pointer-pair set for the
+		// bi-directional (1,2),(2,1) duplicates.
+		auto IsEdgeOwner = [&Neighbors](const int32 i, const int32 Nbr)
+		{
+			return (Nbr > i) || ((Nbr < i) && !Neighbors[Nbr].Contains(i));
+		};
+
+		// Size every child's edge list up front so ConnectNodes doesn't grow them one edge at a time
+		TArray<int32> NumEdges;
+		NumEdges.SetNumZeroed(Children.Num());
 		for (int32 i = 0; i < Neighbors.Num(); i++)
 		{
-			for (int32 j = 0; j < Neighbors[i].Num(); j++)
+			for (const int32 Nbr : Neighbors[i])
 			{
-				TPBDRigidParticleHandle<T, d>* Child1 = Children[i];
-				TPBDRigidParticleHandle<T, d>* Child2 = Children[Neighbors[i][j]];
-				const bool bFirstSmaller = Child1 < Child2;
-				TPair<TPBDRigidParticleHandle<T, d>*, TPBDRigidParticleHandle<T, d>*> SortedPair(
-					bFirstSmaller ? Child1 : Child2, 
-					bFirstSmaller ? Child2 : Child1);
-				if (!UniqueEdges.Find(SortedPair))
+				if (IsEdgeOwner(i, Nbr))
 				{
-					// this does not use ConnectNodes because Neighbors is bi-direction : as in (1,2),(2,1)
-					ConnectNodes(Child1, Child2);
-					UniqueEdges.Add(SortedPair);
+					++NumEdges[i];
+					++NumEdges[Nbr];
+				}
+			}
+		}
+		for (int32 i = 0; i < Children.Num(); i++)
+		{
+			if (TPBDRigidClusteredParticleHandle<T, d>* ClusteredChild = Children[i]->CastToClustered())
+			{
+				TArray<TConnectivityEdge<T>>& Edges = ClusteredChild->ConnectivityEdges();
+				Edges.Reserve(Edges.Num() + NumEdges[i]);
+			}
+		}
+
+		for (int32 i = 0; i < Neighbors.Num(); i++)
+		{
+			for (const int32 Nbr : Neighbors[i])
+			{
+				if (IsEdgeOwner(i, Nbr))
+				{
+					ConnectNodes(Children[i], Children[Nbr]);
 				}
 			}
 		}
@@ -2,6 +2,7 @@
 
 #include "Chaos/PBDRigidDynamicSpringConstraints.h"
 #include "Chaos/Particle/ParticleUtilities.h"
+#include "Chaos/PBDRigidSpringConstraintsUtilities.h"
 #include "Chaos/Utilities.h"
 
 using namespace Chaos;
@@ -135,19 +136,21 @@ void TPBDRigidDynamicSpringConstraints<T, d>::ApplySingle(const T Dt, int32 Cons
 
 	const int32 NumSprings = SpringDistances[ConstraintIndex].Num();
 	const PMatrix<T, d, d> WorldSpaceInvI1 = bIsRigidDynamic0 ? Utilities::ComputeWorldSpaceInertia(Q0, Particle0->InvI()) : PMatrix<T, d, d>(0);
-	const PMatrix<T, d, d> WorldSpaceInvI2 = bIsRigidDynamic1 ? Utilities::ComputeWorldSpaceInertia(Q1, Particle1->InvI()) : PMatrix<T, d, d>(0);;
+	const PMatrix<T, d, d> WorldSpaceInvI2 = bIsRigidDynamic1 ? Utilities::ComputeWorldSpaceInertia(Q1, Particle1->InvI()) : PMatrix<T, d, d>(0);
+	const T InvM0 = bIsRigidDynamic0 ? Particle0->InvM() : (T)0;
+	const T InvM1 = bIsRigidDynamic1 ? Particle1->InvM() : (T)0;
 	for (int32 SpringIndex = 0; SpringIndex < NumSprings; ++SpringIndex)
 	{
 		const TVector<T, d>& Distance0 = Distances[ConstraintIndex][SpringIndex][0];
 		const TVector<T, d>& Distance1 = Distances[ConstraintIndex][SpringIndex][1];
 		const TVector<T, d> WorldSpaceX1 = Particle0->Q().RotateVector(Distance0) + Particle0->P();
 		const TVector<T, d> WorldSpaceX2 = Particle1->Q().RotateVector(Distance1) + Particle1->P();
-		const TVector<T, d> Delta = GetDelta(WorldSpaceX1, WorldSpaceX2, ConstraintIndex, SpringIndex);
+		const TVector<T, d> Delta = ComputeRigidSpringDelta(WorldSpaceX2 - WorldSpaceX1, SpringDistances[ConstraintIndex][SpringIndex], Stiffness, InvM0 + InvM1, Dt);
 
 		if (bIsRigidDynamic0)
 		{
 			const TVector<T, d> Radius = WorldSpaceX1 - P0;
-			P0 += Particle0->InvM() * Delta;
+			P0 += InvM0 * Delta;
 			Q0 += TRotation<T, d>::FromElements(WorldSpaceInvI1 * TVector<T, d>::CrossProduct(Radius, Delta), 0.f) * Q0 * T(0.5);
 			Q0.Normalize();
 			FParticleUtilities::SetCoMWorldTransform(Particle0, P0, Q0);
@@ -156,7 +159,7 @@ void TPBDRigidDynamicSpringConstraints<T, d>::ApplySingle(const T Dt, int32 Cons
 		if (bIsRigidDynamic1)
 		{
 			const TVector<T, d> Radius = WorldSpaceX2 - P1;
-			P1 -= Particle1->InvM() * Delta;
+			P1 -= InvM1 * Delta;
 			Q1 += TRotation<T, d>::FromElements(WorldSpaceInvI2 * TVector<T, d>::CrossProduct(Radius, -Delta), 0.f) * Q1 * T(0.5);
 			Q1.Normalize();
 			FParticleUtilities::SetCoMWorldTransform(Particle1, P1, Q1);
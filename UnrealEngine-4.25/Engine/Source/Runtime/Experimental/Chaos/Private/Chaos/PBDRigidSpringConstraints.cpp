@@ -1,11 +1,41 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Chaos/PBDRigidSpringConstraints.h"
+#include "Chaos/Framework/Parallel.h"
 #include "Chaos/Particle/ParticleUtilities.h"
+#include "Chaos/PBDConstraintColorBatches.h"
+#include "Chaos/PBDRigidSpringConstraintsUtilities.h"
 #include "Chaos/Utilities.h"
 
+#include "HAL/IConsoleManager.h"
+
 namespace Chaos
 {
+	bool bChaos_Spring_ParallelColor_Enabled = false;
+	FAutoConsoleVariableRef CVarChaosSpringParallelColorEnabled(TEXT("p.Chaos.Spring.ParallelColor"), bChaos_Spring_ParallelColor_Enabled, TEXT("Whether to color rigid springs and solve the springs of a color in parallel"));
+
+	int32 Chaos_Spring_ParallelColor_MinBatchSize = 32;
+	FAutoConsoleVariableRef CVarChaosSpringParallelColorMinBatchSize(TEXT("p.Chaos.Spring.ParallelColorMinBatchSize"), Chaos_Spring_ParallelColor_MinBatchSize, TEXT("Minimum number of springs in a color before it is solved in parallel"));
+
+	float Chaos_Spring_Compliance = -1.f;
+	FAutoConsoleVariableRef CVarChaosSpringCompliance(TEXT("p.Chaos.Spring.Compliance"), Chaos_Spring_Compliance, TEXT("If >= 0, rigid springs use this XPBD compliance (inverse stiffness, scaled by 1/Dt^2) instead of their stiffness, so the result does not depend on the timestep. GetDelta has no timestep and always uses the stiffness"));
+
+	// Position correction for a spring whose ends are Difference apart. When Dt is valid and Chaos_Spring_Compliance is set,
+	// the correction is the first XPBD step for that compliance. Otherwise it is the PBD correction scaled by Stiffness,
+	// which is what GetDelta gets: it has no timestep to scale the compliance by.
+	FVec3 ComputeRigidSpringDelta(const FVec3& Difference, const FReal RestLength, const FReal Stiffness, const FReal CombinedInvMass, const FReal Dt)
+	{
+		const FReal Distance = Difference.Size();
+		check(Distance > 1e-7);
+
+		const FVec3 Delta = (Distance - RestLength) / Distance * Difference;
+		if ((Chaos_Spring_Compliance >= 0) && (Dt > SMALL_NUMBER))
+		{
+			return Delta / (CombinedInvMass + Chaos_Spring_Compliance / (Dt * Dt));
+		}
+		return Stiffness * Delta / CombinedInvMass;
+	}
+
 	//
 	// Handle Impl
 	//
@@ -111,22 +141,24 @@ namespace Chaos
 			return FVec3(0);
 		}
 
-		const FVec3 Difference = WorldSpaceX2 - WorldSpaceX1;
-
-		const float Distance = Difference.Size();
-		check(Distance > 1e-7);
-
-		const FVec3 Direction = Difference / Distance;
-		const FVec3 Delta = (Distance - SpringSettings[ConstraintIndex].RestLength) * Direction;
 		const FReal InvM0 = (bIsRigidDynamic0) ? PBDRigid0->InvM() : (FReal)0;
 		const FReal InvM1 = (bIsRigidDynamic1) ? PBDRigid1->InvM() : (FReal)0;
-		const FReal CombinedMass = InvM0 + InvM1;
 
-		return SpringSettings[ConstraintIndex].Stiffness * Delta / CombinedMass;
+		// No timestep here to scale p.Chaos.Spring.Compliance by, so this is always the stiffness based correction
+		return ComputeRigidSpringDelta(WorldSpaceX2 - WorldSpaceX1, SpringSettings[ConstraintIndex].RestLength, SpringSettings[ConstraintIndex].Stiffness, InvM0 + InvM1, (FReal)0);
 	}
 
 	bool FPBDRigidSpringConstraints::Apply(const FReal Dt, const int32 It, const int32 NumIts)
 	{
+		if (bChaos_Spring_ParallelColor_Enabled)
+		{
+			const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, Constraints.GetData(), NumConstraints(), It,
+				[](int32 Index) { return 0; },
+				[this](int32 Index) -> const FConstrainedParticlePair& { return Constraints[Index]; });
+			Batches.Solve(Chaos_Spring_ParallelColor_MinBatchSize, [this, Dt](int32 OrderIndex, int32 ConstraintIndex) { ApplySingle(Dt, ConstraintIndex); });
+			return false;
+		}
+
 		for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints(); ++ConstraintIndex)
 		{
 			ApplySingle(Dt, ConstraintIndex);
@@ -136,6 +168,15 @@ namespace Chaos
 
 	bool FPBDRigidSpringConstraints::Apply(const FReal Dt, const TArray<FConstraintContainerHandle*>& InConstraintHandles, const int32 It, const int32 NumIts)
 	{
+		if (bChaos_Spring_ParallelColor_Enabled)
+		{
+			const FConstraintColorBatches& Batches = FConstraintColorBatchCache::Get().FindOrBuild(this, InConstraintHandles.GetData(), InConstraintHandles.Num(), It,
+				[](int32 Index) { return 0; },
+				[this, &InConstraintHandles](int32 Index) -> const FConstrainedParticlePair& { return Constraints[InConstraintHandles[Index]->GetConstraintIndex()]; });
+			Batches.Solve(Chaos_Spring_ParallelColor_MinBatchSize, [this, Dt, &InConstraintHandles](int32 OrderIndex, int32 Index) { ApplySingle(Dt, InConstraintHandles[Index]->GetConstraintIndex()); });
+			return false;
+		}
+
 		for (FConstraintContainerHandle* ConstraintHandle : InConstraintHandles)
 		{
 			ApplySingle(Dt, ConstraintHandle->GetConstraintIndex());
@@ -156,7 +197,9 @@ namespace Chaos
 
 		const FVec3 WorldSpaceX1 = Particle0->Q().RotateVector(Distances[ConstraintIndex][0]) + Particle0->P();
 		const FVec3 WorldSpaceX2 = Particle1->Q().RotateVector(Distances[ConstraintIndex][1]) + Particle1->P();
-		const FVec3 Delta = GetDelta(ConstraintIndex, WorldSpaceX1, WorldSpaceX2);
+		const FReal InvM0 = (bIsRigidDynamic0) ? Particle0->InvM() : (FReal)0;
+		const FReal InvM1 = (bIsRigidDynamic1) ? Particle1->InvM() : (FReal)0;
+		const FVec3 Delta = ComputeRigidSpringDelta(WorldSpaceX2 - WorldSpaceX1, SpringSettings[ConstraintIndex].RestLength, SpringSettings[ConstraintIndex].Stiffness, InvM0 + InvM1, Dt);
 
 		if (bIsRigidDynamic0)
 		{
@@ -0,0 +1,11 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "Chaos/Core.h"
+
+namespace Chaos
+{
+	// Position correction for a rigid spring whose ends are Difference apart, shared by the rigid and dynamic spring
+	// constraints. Defined in PBDRigidSpringConstraints.cpp.
+	FVec3 ComputeRigidSpringDelta(const FVec3& Difference, const FReal RestLength, const FReal Stiffness, const FReal CombinedInvMass, const FReal Dt);
+}
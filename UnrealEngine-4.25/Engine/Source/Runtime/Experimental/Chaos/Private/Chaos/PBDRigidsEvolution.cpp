@@ -3,9 +3,11 @@
 #include "Chaos/Defines.h"
 #include "Chaos/PBDRigidsSOAs.h"
 #include "ChaosStats.h"
+#include "ChaosLog.h"
 #include "Chaos/PBDRigidsEvolutionGBF.h"
 #include "Chaos/ParticleHandle.h"
 #include "Chaos/SpatialAccelerationCollection.h"
+#include "Chaos/Framework/Parallel.h"
 
 int32 ChaosRigidsEvolutionApplyAllowEarlyOutCVar = 1;
 FAutoConsoleVariableRef CVarChaosRigidsEvolutionApplyAllowEarlyOut(TEXT("p.ChaosRigidsEvolutionApplyAllowEarlyOut"), ChaosRigidsEvolutionApplyAllowEarlyOutCVar, TEXT("Allow Chaos Rigids Evolution apply iterations to early out when resolved.[def:1]"));
@@ -24,6 +26,12 @@ namespace Chaos
 	CHAOS_API int32 FixBadAccelerationStructureRemoval = 1;
 	FAutoConsoleVariableRef CVarFixBadAccelerationStructureRemoval(TEXT("p.FixBadAccelerationStructureRemoval"), FixBadAccelerationStructureRemoval, TEXT(""));
 
+	int32 AccelerationStructureFullBuildThreshold = 1000;
+	FAutoConsoleVariableRef CVarAccelerationStructureFullBuildThreshold(TEXT("p.AccelerationStructureFullBuildThreshold"), AccelerationStructureFullBuildThreshold, TEXT("Number of pending acceleration structure updates above which the async rebuild skips time-slicing and builds in one go [def:1000]"));
+
+	int32 AccelerationStructureParallelBucketBuild = 1;
+	FAutoConsoleVariableRef CVarAccelerationStructureParallelBucketBuild(TEXT("p.AccelerationStructureParallelBucketBuild"), AccelerationStructureParallelBucketBuild, TEXT("Whether the async acceleration structure task builds its per bucket substructures in parallel [def:1]"));
+
 	struct FAccelerationConfig
 	{
 		int32 BroadphaseType;
@@ -48,7 +56,7 @@ namespace Chaos
 		}
 	} ConfigSettings;
 
-	FAutoConsoleVariableRef CVarBroadphaseIsTree(TEXT("p.BroadphaseType"), ConfigSettings.BroadphaseType, TEXT(""));
+	FAutoConsoleVariableRef CVarBroadphaseIsTree(TEXT("p.BroadphaseType"), ConfigSettings.BroadphaseType, TEXT("Broadphase acceleration structure. 0: Grid, 1: AABB tree, 2: AABB tree of grids, 3: AABB tree + grid for large objects, 4: AABB tree of grids + grid for large objects [def:3]"));
 	FAutoConsoleVariableRef CVarBoundingVolumeNumCells(TEXT("p.BoundingVolumeNumCells"), ConfigSettings.BVNumCells, TEXT(""));
 	FAutoConsoleVariableRef CVarMaxChildrenInLeaf(TEXT("p.MaxChildrenInLeaf"), ConfigSettings.MaxChildrenInLeaf, TEXT(""));
 	FAutoConsoleVariableRef CVarMaxTreeDepth(TEXT("p.MaxTreeDepth"), ConfigSettings.MaxTreeDepth, TEXT(""));
@@ -57,6 +65,24 @@ namespace Chaos
 	FAutoConsoleVariableRef CVarMaxPayloadSize(TEXT("p.MaxPayloadSize"), ConfigSettings.MaxPayloadSize, TEXT(""));
 	FAutoConsoleVariableRef CVarIterationsPerTimeSlice(TEXT("p.IterationsPerTimeSlice"), ConfigSettings.IterationsPerTimeSlice, TEXT(""));
 
+	/** The p.BroadphaseType in use. Unknown types fall back to the default, with a warning, so the bucket setup always matches a known type. */
+	static int32 GetBroadphaseType()
+	{
+		const int32 BroadphaseType = ConfigSettings.BroadphaseType;
+		if ((BroadphaseType >= 0) && (BroadphaseType <= 4))
+		{
+			return BroadphaseType;
+		}
+
+		static int32 LastWarnedType = 3;
+		if (BroadphaseType != LastWarnedType)
+		{
+			LastWarnedType = BroadphaseType;
+			UE_LOG(LogChaos, Warning, TEXT("Unknown p.BroadphaseType %d, using 3"), BroadphaseType);
+		}
+		return 3;
+	}
+
 	struct FDefaultCollectionFactory : public ISpatialAccelerationCollectionFactory
 	{
 		FAccelerationConfig Config;
@@ -69,7 +95,7 @@ namespace Chaos
 		{
 			TConstParticleView<FSpatialAccelerationCache> Empty;
 
-			const uint16 NumBuckets = ConfigSettings.BroadphaseType >= 3 ? 2 : 1;
+			const uint16 NumBuckets = GetBroadphaseType() >= 3 ? 2 : 1;
 			auto Collection = new TSpatialAccelerationCollection<AABBTreeType, BVType, AABBTreeOfGridsType>();
 
 			for (uint16 BucketIdx = 0; BucketIdx < NumBuckets; ++BucketIdx)
@@ -82,31 +108,32 @@ namespace Chaos
 
 		virtual uint8 GetActiveBucketsMask() const
 		{
-			return ConfigSettings.BroadphaseType >= 3 ? 3 : 1;
+			return GetBroadphaseType() >= 3 ? 3 : 1;
 		}
 
 		virtual TUniquePtr<ISpatialAcceleration<TAccelerationStructureHandle<FReal, 3>, FReal, 3>> CreateAccelerationPerBucket_Threaded(const TConstParticleView<FSpatialAccelerationCache>& Particles, uint16 BucketIdx, bool ForceFullBuild) override
 		{
+			const int32 BroadphaseType = GetBroadphaseType();
 			switch (BucketIdx)
 			{
 			case 0:
 			{
-				if (ConfigSettings.BroadphaseType == 0)
+				if (BroadphaseType == 0)
 				{
 					return MakeUnique<BVType>(Particles, false, 0, ConfigSettings.BVNumCells, ConfigSettings.MaxPayloadSize);
 				}
-				else if (ConfigSettings.BroadphaseType == 1 || ConfigSettings.BroadphaseType == 3)
+				else if (BroadphaseType == 1 || BroadphaseType == 3)
 				{
 					return MakeUnique<AABBTreeType>(Particles, ConfigSettings.MaxChildrenInLeaf, ConfigSettings.MaxTreeDepth, ConfigSettings.MaxPayloadSize, ForceFullBuild ? 0 : ConfigSettings.IterationsPerTimeSlice);
 				}
-				else if (ConfigSettings.BroadphaseType == 4 || ConfigSettings.BroadphaseType == 2)
+				else
 				{
 					return MakeUnique<AABBTreeOfGridsType>(Particles, ConfigSettings.AABBMaxChildrenInLeaf, ConfigSettings.AABBMaxTreeDepth, ConfigSettings.MaxPayloadSize);
 				}
 			}
 			case 1:
 			{
-				ensure(ConfigSettings.BroadphaseType == 3 || ConfigSettings.BroadphaseType == 4);
+				ensure(BroadphaseType == 3 || BroadphaseType == 4);
 				return MakeUnique<BVType>(Particles, false, 0, ConfigSettings.BVNumCells, ConfigSettings.MaxPayloadSize);
 			}
 			default:
@@ -262,25 +289,36 @@ namespace Chaos
 			}
 		}
 
-		//todo: creation can go wide, insertion to collection cannot
+		//creation can go wide, insertion to collection cannot
+		uint8 BucketsToBuild[8];
+		int32 NumBucketsToBuild = 0;
 		for (uint8 BucketIdx = 0; BucketIdx < 8; ++BucketIdx)
 		{
 			if (ViewsPerBucket[BucketIdx].Num())
 			{
-				SCOPE_CYCLE_COUNTER(STAT_CreateInitialAccelerationStructure);
-
-				auto ParticleView = MakeConstParticleView(MoveTemp(ViewsPerBucket[BucketIdx]));
-				auto NewStruct = SpatialCollectionFactory.CreateAccelerationPerBucket_Threaded(ParticleView, BucketIdx, IsForceFullBuild);
+				BucketsToBuild[NumBucketsToBuild++] = BucketIdx;
+			}
+		}
 
-				// we kicked of the creation of a new structure and it's going to time-slice the work
-				if (!NewStruct->IsAsyncTimeSlicingComplete())
-				{
-					IsTimeSlicingProgressing = true;
-				}
+		TUniquePtr<ISpatialAcceleration<TAccelerationStructureHandle<FReal, 3>, FReal, 3>> NewStructs[8];
+		PhysicsParallelFor(NumBucketsToBuild, [&](int32 BuildIdx)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CreateInitialAccelerationStructure);
 
-				AccelerationStructure->AddSubstructure(MoveTemp(NewStruct), BucketIdx);
+			const uint8 BucketIdx = BucketsToBuild[BuildIdx];
+			auto ParticleView = MakeConstParticleView(MoveTemp(ViewsPerBucket[BucketIdx]));
+			NewStructs[BuildIdx] = SpatialCollectionFactory.CreateAccelerationPerBucket_Threaded(ParticleView, BucketIdx, IsForceFullBuild);
+		}, bIsSingleThreaded || !AccelerationStructureParallelBucketBuild || NumBucketsToBuild < 2);
 
+		for (int32 BuildIdx = 0; BuildIdx < NumBucketsToBuild; ++BuildIdx)
+		{
+			// we kicked of the creation of a new structure and it's going to time-slice the work
+			if (!NewStructs[BuildIdx]->IsAsyncTimeSlicingComplete())
+			{
+				IsTimeSlicingProgressing = true;
 			}
+
+			AccelerationStructure->AddSubstructure(MoveTemp(NewStructs[BuildIdx]), BucketsToBuild[BuildIdx]);
 		}
 
 		AccelerationStructure->SetAllAsyncTasksComplete(!IsTimeSlicingProgressing);
@@ -419,7 +457,7 @@ namespace Chaos
 		SCOPE_CYCLE_COUNTER(STAT_ComputeIntermediateSpatialAcceleration);
 		CHAOS_SCOPED_TIMER(ComputeIntermediateSpatialAcceleration);
 
-		bool ForceFullBuild = InternalAccelerationQueue.Num() > 1000;
+		bool ForceFullBuild = InternalAccelerationQueue.Num() > AccelerationStructureFullBuildThreshold;
 
 		if (!AccelerationStructureTaskComplete)
 		{
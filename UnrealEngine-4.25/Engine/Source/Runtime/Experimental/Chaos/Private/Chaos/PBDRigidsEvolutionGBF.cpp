@@ -1,5 +1,6 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 #include "Chaos/PBDRigidsEvolutionGBF.h"
+#include "Chaos/PBDRigidsEvolutionRollback.h"
 #include "Chaos/Defines.h"
 #include "Chaos/Framework/Parallel.h"
 #include "Chaos/ImplicitObjectTransformed.h"
@@ -20,6 +21,11 @@
 #include "Misc/ScopeLock.h"
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Async/Async.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/MemStack.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
 //PRAGMA_DISABLE_OPTIMIZATION
 
@@ -58,6 +64,18 @@ FAutoConsoleVariableRef CVarHackCCDVelThreshold(TEXT("p.Chaos.CCD.EnableThreshol
 float HackCCD_DepthThreshold = 0.05f;
 FAutoConsoleVariableRef CVarHackCCDDepthThreshold(TEXT("p.Chaos.CCD.DepthThreshold"), HackCCD_DepthThreshold, TEXT("When returning to TOI, leave this much contact depth (as a fraction of MinBounds)"));
 
+int32 ChaosCCDParallel = 1;
+FAutoConsoleVariableRef CVarChaosCCDParallel(TEXT("p.Chaos.CCD.Parallel"), ChaosCCDParallel, TEXT("Move fast particles back to their time of impact in parallel. Fast particles whose sweeps overlap each other are still processed serially.[def:1]"));
+
+int32 ChaosSolverIslandCostScheduling = 1;
+FAutoConsoleVariableRef CVarChaosSolverIslandCostScheduling(TEXT("p.Chaos.Solver.IslandCostScheduling"), ChaosSolverIslandCostScheduling, TEXT("Solve islands most expensive first, with workers pulling islands from a shared queue rather than fixed ranges.[def:1]"));
+
+float ChaosSolverAdaptiveStepMaxDistance = 0.f;
+FAutoConsoleVariableRef CVarChaosSolverAdaptiveStepMaxDistance(TEXT("p.Chaos.Solver.AdaptiveStepMaxDistance"), ChaosSolverAdaptiveStepMaxDistance, TEXT("If > 0, Advance takes extra steps (still limited by MaxSteps) so the fastest active dynamic particle moves at most this far (cm) per step. 0 to disable.[def:0]"));
+
+float ChaosSolverStepTimeBudgetMs = 0.f;
+FAutoConsoleVariableRef CVarChaosSolverStepTimeBudgetMs(TEXT("p.Chaos.Solver.StepTimeBudgetMs"), ChaosSolverStepTimeBudgetMs, TEXT("If > 0, Advance stops taking further steps when the next one is predicted to exceed this budget (ms). The last step taken still reaches the kinematic targets; the skipped time is dropped so the simulation slows down rather than spiking. 0 to disable.[def:0]"));
+
 
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::AdvanceOneTimeStep"), STAT_Evolution_AdvanceOneTimeStep, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::Integrate"), STAT_Evolution_Integrate, STATGROUP_Chaos);
@@ -67,52 +85,549 @@ DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::UnprepareConstraints"), STAT_Ev
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::ApplyConstraints"), STAT_Evolution_ApplyConstraints, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::UpdateVelocities"), STAT_Evolution_UpdateVelocites, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::ApplyPushOut"), STAT_Evolution_ApplyPushOut, STATGROUP_Chaos);
+DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::CCD"), STAT_Evolution_CCD, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::DetectCollisions"), STAT_Evolution_DetectCollisions, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::UpdateConstraintPositionBasedState"), STAT_Evolution_UpdateConstraintPositionBasedState, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::CreateConstraintGraph"), STAT_Evolution_CreateConstraintGraph, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::CreateIslands"), STAT_Evolution_CreateIslands, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::ParallelSolve"), STAT_Evolution_ParallelSolve, STATGROUP_Chaos);
 DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::DeactivateSleep"), STAT_Evolution_DeactivateSleep, STATGROUP_Chaos);
+DECLARE_MEMORY_STAT(TEXT("FPBDRigidsEvolutionGBF Serialized Footprint"), STAT_Evolution_SerializedFootprint, STATGROUP_Chaos);
+DECLARE_MEMORY_STAT(TEXT("FPBDRigidsEvolutionGBF Serialized Particles"), STAT_Evolution_SerializedParticles, STATGROUP_Chaos);
+DECLARE_MEMORY_STAT(TEXT("FPBDRigidsEvolutionGBF Serialized Geometry"), STAT_Evolution_SerializedGeometry, STATGROUP_Chaos);
+DECLARE_MEMORY_STAT(TEXT("FPBDRigidsEvolutionGBF Serialized Acceleration"), STAT_Evolution_SerializedAcceleration, STATGROUP_Chaos);
 
 int32 SerializeEvolution = 0;
 FAutoConsoleVariableRef CVarSerializeEvolution(TEXT("p.SerializeEvolution"), SerializeEvolution, TEXT(""));
 
+int32 SerializeEvolutionCompressed = 0;
+FAutoConsoleVariableRef CVarSerializeEvolutionCompressed(TEXT("p.SerializeEvolutionCompressed"), SerializeEvolutionCompressed, TEXT("If set, evolutions captured by p.SerializeEvolution or p.SerializeEvolutionHistory are zlib compressed (.zbin: uncompressed size followed by FArchive::SerializeCompressed data)."));
+
+int32 SerializeEvolutionHistory = 0;
+FAutoConsoleVariableRef CVarSerializeEvolutionHistory(TEXT("p.SerializeEvolutionHistory"), SerializeEvolutionHistory, TEXT("Keep the serialized state of the last N stepped evolutions in memory and write them out with p.FlushEvolutionHistory, so the frames leading up to a problem can be captured after it happens. Serializing still runs on the simulation thread every step."));
+
+int32 FlushEvolutionHistory = 0;
+FAutoConsoleVariableRef CVarFlushEvolutionHistory(TEXT("p.FlushEvolutionHistory"), FlushEvolutionHistory, TEXT("Write the captures kept by p.SerializeEvolutionHistory to disk on a background task and empty the history. Resets itself after the flush."));
+
+CSV_DEFINE_CATEGORY(ChaosEvolution, false);
+
+int32 TraceEvolutionIslands = 0;
+FAutoConsoleVariableRef CVarTraceEvolutionIslands(TEXT("p.TraceEvolutionIslands"), TraceEvolutionIslands, TEXT("Emit a named profiler event per solved island, labelled with its index, particle and constraint counts, so spikes can be attributed to islands on a timeline."));
+
+/** Named profiler event around one island solve, only when p.TraceEvolutionIslands is enabled. */
+struct FScopedIslandTraceEvent
+{
+	FScopedIslandTraceEvent(const int32 Island, const int32 NumIslandParticles, const int32 NumIslandConstraints)
+		: bActive(TraceEvolutionIslands != 0)
+	{
+		if (bActive)
+		{
+			FPlatformMisc::BeginNamedEvent(FColor::Turquoise, *FString::Printf(TEXT("Island %d (%d particles, %d constraints)"), Island, NumIslandParticles, NumIslandConstraints));
+		}
+	}
+
+	~FScopedIslandTraceEvent()
+	{
+		if (bActive)
+		{
+			FPlatformMisc::EndNamedEvent();
+		}
+	}
+
+	const bool bActive;
+};
+
+int32 ReportEvolutionMemory = 0;
+FAutoConsoleVariableRef CVarReportEvolutionMemory(TEXT("p.ReportEvolutionMemory"), ReportEvolutionMemory, TEXT("Measure the serialized footprint of the next stepped evolution split into particles, geometry and acceleration structures, log it and publish it to the Chaos memory stats. Resets itself after the report."));
+
 #if !UE_BUILD_SHIPPING
+/** Archive that discards everything written to it and only keeps track of the size. */
+class FChaosByteCountingArchive : public FArchive
+{
+public:
+	FChaosByteCountingArchive()
+		: Offset(0)
+	{
+		SetIsSaving(true);
+		SetIsPersistent(true);
+	}
+
+	virtual void Serialize(void* Data, int64 Num) override
+	{
+		Offset += Num;
+	}
+
+	virtual int64 Tell() override
+	{
+		return Offset;
+	}
+
+	virtual FString GetArchiveName() const override
+	{
+		return TEXT("FChaosByteCountingArchive");
+	}
+
+private:
+	int64 Offset;
+};
+
 template <typename TEvolution>
-void SerializeToDisk(TEvolution& Evolution)
+void ReportMemory(TEvolution& Evolution)
+{
+	// Run the evolution through the same serialization path as SerializeToDisk without
+	// keeping the bytes, then split the total into sections.  Geometry is written first so
+	// the particle pass only writes references to it, and whatever the full pass adds on
+	// top of particles and geometry is the acceleration structure and evolution settings.
+	// Constraints are not part of the evolution's serialization, so only their count is logged.
+	FChaosByteCountingArchive SectionCounter;
+	int64 GeometryBytes = 0;
+	int64 ParticleBytes = 0;
+	{
+		FChaosArchive Ar(SectionCounter);
+		for (auto& Particle : Evolution.GetParticles().GetNonDisabledView())
+		{
+			TSerializablePtr<FImplicitObject> Geometry = Particle.Geometry();
+			Ar << Geometry;
+		}
+		GeometryBytes = SectionCounter.Tell();
+		Evolution.GetParticles().Serialize(Ar);
+		ParticleBytes = SectionCounter.Tell() - GeometryBytes;
+	}
+
+	FChaosByteCountingArchive Counter;
+	{
+		FChaosArchive Ar(Counter);
+		Evolution.Serialize(Ar);
+	}
+	const int64 NumBytes = Counter.Tell();
+	const int64 AccelerationBytes = FMath::Max<int64>(NumBytes - GeometryBytes - ParticleBytes, 0);
+
+	SET_MEMORY_STAT(STAT_Evolution_SerializedFootprint, NumBytes);
+	SET_MEMORY_STAT(STAT_Evolution_SerializedParticles, ParticleBytes);
+	SET_MEMORY_STAT(STAT_Evolution_SerializedGeometry, GeometryBytes);
+	SET_MEMORY_STAT(STAT_Evolution_SerializedAcceleration, AccelerationBytes);
+
+	const double ToMB = 1.0 / (1024.0 * 1024.0);
+	UE_LOG(LogChaos, Log, TEXT("Evolution serialized footprint: %lld bytes (%.2f MB)"), NumBytes, (double)NumBytes * ToMB);
+	UE_LOG(LogChaos, Log, TEXT("  Particles: %lld bytes (%.2f MB)"), ParticleBytes, (double)ParticleBytes * ToMB);
+	UE_LOG(LogChaos, Log, TEXT("  Geometry: %lld bytes (%.2f MB)"), GeometryBytes, (double)GeometryBytes * ToMB);
+	UE_LOG(LogChaos, Log, TEXT("  Acceleration structures and settings: %lld bytes (%.2f MB)"), AccelerationBytes, (double)AccelerationBytes * ToMB);
+	UE_LOG(LogChaos, Log, TEXT("  Collision constraints: %d (not serialized)"), Evolution.GetCollisionConstraints().NumConstraints());
+}
+
+static FString MakeEvolutionCaptureFileName(const bool bCompress)
 {
 	const TCHAR* FilePrefix = TEXT("ChaosEvolution");
 	const FString FullPathPrefix = FPaths::ProfilingDir() / FilePrefix;
 
-	static FCriticalSection CS;	//many evolutions could be running in parallel, serialize one at a time to avoid file conflicts
+	// Only the file name needs to be unique: many evolutions could be running in parallel.
+	// Probe for existing captures once, then keep counting from there.
+	static FCriticalSection CS;
+	static int32 NextFileIndex = INDEX_NONE;
 	FScopeLock Lock(&CS);
+	if (NextFileIndex == INDEX_NONE)
+	{
+		NextFileIndex = 0;
+		while (IFileManager::Get().FileExists(*FString::Printf(TEXT("%s_%d.bin"), *FullPathPrefix, NextFileIndex))
+			|| IFileManager::Get().FileExists(*FString::Printf(TEXT("%s_%d.zbin"), *FullPathPrefix, NextFileIndex)))
+		{
+			++NextFileIndex;
+		}
+	}
+	return FString::Printf(TEXT("%s_%d.%s"), *FullPathPrefix, NextFileIndex++, bCompress ? TEXT("zbin") : TEXT("bin"));
+}
+
+template <typename TEvolution>
+void SerializeToBytes(TEvolution& Evolution, TArray<uint8>& Bytes)
+{
+	FMemoryWriter Writer(Bytes, /*bIsPersistent=*/true);
+	FChaosArchive Ar(Writer);
+	Evolution.Serialize(Ar);
+}
+
+static void WriteCaptureAsync(TArray<uint8>&& Bytes)
+{
+	const bool bCompress = SerializeEvolutionCompressed != 0;
+	const FString UseFileName = MakeEvolutionCaptureFileName(bCompress);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [UseFileName, bCompress, Bytes = MoveTemp(Bytes)]() mutable
+	{
+		//this is not actually file safe but oh well, very unlikely someone else is trying to create this file at the same time
+		TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*UseFileName));
+		if (File)
+		{
+			UE_LOG(LogChaos, Log, TEXT("SerializeToDisk File: %s"), *UseFileName);
+			if (bCompress)
+			{
+				int64 UncompressedSize = Bytes.Num();
+				*File << UncompressedSize;
+				File->SerializeCompressed(Bytes.GetData(), UncompressedSize, NAME_Zlib);
+			}
+			else
+			{
+				File->Serialize(Bytes.GetData(), Bytes.Num());
+			}
+		}
+		else
+		{
+			UE_LOG(LogChaos, Warning, TEXT("Could not create file(%s)"), *UseFileName);
+		}
+	});
+}
+
+template <typename TEvolution>
+void SerializeToDisk(TEvolution& Evolution)
+{
+	// The evolution is serialized into memory on the calling thread, which blocks the step
+	// for as long as the serialization takes.  Only compression and file IO are moved to a
+	// background task.
+	TArray<uint8> Bytes;
+	SerializeToBytes(Evolution, Bytes);
+	WriteCaptureAsync(MoveTemp(Bytes));
+}
+
+/** The last p.SerializeEvolutionHistory captures of every evolution, oldest first, shared by all evolutions. */
+struct FEvolutionCaptureHistory
+{
+	FCriticalSection CS;
+	TArray<TArray<uint8>> Captures;
+	/** Where the next capture goes. The oldest capture is at NextCapture modulo the number of captures. */
+	int32 NextCapture = 0;
+
+	static FEvolutionCaptureHistory& Get()
+	{
+		static FEvolutionCaptureHistory History;
+		return History;
+	}
+};
 
-	int32 Tries = 0;
-	FString UseFileName;
-	do
+template <typename TEvolution>
+void CaptureToHistory(TEvolution& Evolution)
+{
+	// Serializing blocks the step just like SerializeToDisk, but nothing touches the disk until a flush
+	TArray<uint8> Bytes;
+	SerializeToBytes(Evolution, Bytes);
+
+	FEvolutionCaptureHistory& History = FEvolutionCaptureHistory::Get();
+	FScopeLock Lock(&History.CS);
+	const int32 MaxCaptures = FMath::Max(SerializeEvolutionHistory, 1);
+	if (History.Captures.Num() > MaxCaptures)
 	{
-		UseFileName = FString::Printf(TEXT("%s_%d.bin"), *FullPathPrefix, Tries++);
-	} while (IFileManager::Get().FileExists(*UseFileName));
+		// The history was shrunk: drop the oldest captures and keep the rest in order
+		TArray<TArray<uint8>> Kept;
+		for (int32 Index = History.Captures.Num() - MaxCaptures; Index < History.Captures.Num(); ++Index)
+		{
+			Kept.Add(MoveTemp(History.Captures[(History.NextCapture + Index) % History.Captures.Num()]));
+		}
+		History.Captures = MoveTemp(Kept);
+		History.NextCapture = 0;
+	}
 
-	//this is not actually file safe but oh well, very unlikely someone else is trying to create this file at the same time
-	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*UseFileName));
-	if (File)
+	if (History.Captures.Num() < MaxCaptures)
 	{
-		FChaosArchive Ar(*File);
-		UE_LOG(LogChaos, Log, TEXT("SerializeToDisk File: %s"), *UseFileName);
-		Evolution.Serialize(Ar);
+		// Insert just after the newest capture, in front of the oldest
+		History.Captures.Insert(MoveTemp(Bytes), History.NextCapture);
+		++History.NextCapture;
 	}
 	else
 	{
-		UE_LOG(LogChaos, Warning, TEXT("Could not create file(%s)"), *UseFileName);
+		const int32 Slot = History.NextCapture % MaxCaptures;
+		History.Captures[Slot] = MoveTemp(Bytes);
+		History.NextCapture = Slot + 1;
 	}
 }
+
+static void FlushHistoryToDisk()
+{
+	FEvolutionCaptureHistory& History = FEvolutionCaptureHistory::Get();
+	FScopeLock Lock(&History.CS);
+	const int32 NumCaptures = History.Captures.Num();
+	for (int32 Index = 0; Index < NumCaptures; ++Index)
+	{
+		WriteCaptureAsync(MoveTemp(History.Captures[(History.NextCapture + Index) % NumCaptures]));
+	}
+	History.Captures.Reset();
+	History.NextCapture = 0;
+}
 #endif
 
+DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::CaptureRollbackState"), STAT_Evolution_CaptureRollbackState, STATGROUP_Chaos);
+DECLARE_CYCLE_STAT(TEXT("FPBDRigidsEvolutionGBF::RestoreRollbackState"), STAT_Evolution_RestoreRollbackState, STATGROUP_Chaos);
+
+// Rollback state is a flat byte stream: a header followed by one fixed size record per non-disabled particle, in view
+// order. Records only hold the mutable per-step state, everything else (geometry, masses, materials) is assumed to be
+// unchanged between capture and restore. Fixed size records let capture and restore run in parallel and make
+// consecutive captures line up byte for byte, which is what the delta encoding below relies on.
+namespace RollbackState
+{
+	static const uint32 Magic = 0x43524253;	// 'CRBS'
+
+	struct FHeader
+	{
+		uint32 Magic;
+		int32 NumParticles;
+	};
+
+	// Particle handle, object state (INDEX_NONE for non-rigid particles), X, R, P, Q (rigid only), V, W (kinematic and rigid),
+	// strain (clustered only)
+	static const int32 RecordSize = sizeof(uint64) + sizeof(int8) + 4 * sizeof(FVec3) + 2 * sizeof(FRotation3) + sizeof(FReal);
+
+	template <typename TValue>
+	FORCEINLINE void Write(uint8*& Cursor, const TValue& Value)
+	{
+		FMemory::Memcpy(Cursor, &Value, sizeof(TValue));
+		Cursor += sizeof(TValue);
+	}
+
+	template <typename TValue>
+	FORCEINLINE void Read(const uint8*& Cursor, TValue& Value)
+	{
+		FMemory::Memcpy(&Value, Cursor, sizeof(TValue));
+		Cursor += sizeof(TValue);
+	}
+
+	static void GatherHandles(FPBDRigidsEvolutionGBF& Evolution, TArray<TGeometryParticleHandle<FReal, 3>*>& OutHandles)
+	{
+		for (auto& Particle : Evolution.GetParticles().GetNonDisabledView())
+		{
+			OutHandles.Add(Particle.Handle());
+		}
+	}
+}
+
+void CaptureEvolutionRollbackState(FPBDRigidsEvolutionGBF& Evolution, TArray<uint8>& OutState)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Evolution_CaptureRollbackState);
+
+	TArray<TGeometryParticleHandle<FReal, 3>*> Handles;
+	RollbackState::GatherHandles(Evolution, Handles);
+	const int32 NumParticles = Handles.Num();
+
+	OutState.SetNumUninitialized(sizeof(RollbackState::FHeader) + NumParticles * RollbackState::RecordSize);
+	RollbackState::FHeader Header;
+	Header.Magic = RollbackState::Magic;
+	Header.NumParticles = NumParticles;
+	FMemory::Memcpy(OutState.GetData(), &Header, sizeof(Header));
+
+	uint8* Records = OutState.GetData() + sizeof(RollbackState::FHeader);
+	PhysicsParallelFor(NumParticles, [&](int32 Index)
+	{
+		const TGeometryParticleHandle<FReal, 3>* Handle = Handles[Index];
+		const TPBDRigidParticleHandle<FReal, 3>* Rigid = Handle->CastToRigidParticle();
+		const TKinematicGeometryParticleHandle<FReal, 3>* Kinematic = Handle->CastToKinematicParticle();
+		uint8* Cursor = Records + Index * RollbackState::RecordSize;
+		RollbackState::Write(Cursor, (uint64)(UPTRINT)Handle);
+		RollbackState::Write(Cursor, Rigid ? (int8)Rigid->ObjectState() : (int8)INDEX_NONE);
+		RollbackState::Write(Cursor, Handle->X());
+		RollbackState::Write(Cursor, Handle->R());
+		// Non-rigid particles still write the full record so that every record has the same size
+		RollbackState::Write(Cursor, Rigid ? Rigid->P() : Handle->X());
+		RollbackState::Write(Cursor, Rigid ? Rigid->Q() : Handle->R());
+		RollbackState::Write(Cursor, Kinematic ? Kinematic->V() : FVec3(0));
+		RollbackState::Write(Cursor, Kinematic ? Kinematic->W() : FVec3(0));
+		const TPBDRigidClusteredParticleHandle<FReal, 3>* Clustered = Rigid ? Rigid->CastToClustered() : nullptr;
+		RollbackState::Write(Cursor, Clustered ? Clustered->Strain() : (FReal)0);
+	});
+}
+
+bool RestoreEvolutionRollbackState(FPBDRigidsEvolutionGBF& Evolution, const TArray<uint8>& State)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Evolution_RestoreRollbackState);
+
+	if (State.Num() < (int32)sizeof(RollbackState::FHeader))
+	{
+		return false;
+	}
+
+	RollbackState::FHeader Header;
+	FMemory::Memcpy(&Header, State.GetData(), sizeof(Header));
+	if (Header.Magic != RollbackState::Magic || State.Num() != (int32)sizeof(RollbackState::FHeader) + Header.NumParticles * RollbackState::RecordSize)
+	{
+		return false;
+	}
+
+	TArray<TGeometryParticleHandle<FReal, 3>*> Handles;
+	RollbackState::GatherHandles(Evolution, Handles);
+	if (Handles.Num() != Header.NumParticles)
+	{
+		return false;
+	}
+
+	const uint8* Records = State.GetData() + sizeof(RollbackState::FHeader);
+	for (int32 Index = 0; Index < Handles.Num(); ++Index)
+	{
+		uint64 CapturedHandle;
+		const uint8* Cursor = Records + Index * RollbackState::RecordSize;
+		RollbackState::Read(Cursor, CapturedHandle);
+		if (CapturedHandle != (uint64)(UPTRINT)Handles[Index])
+		{
+			UE_LOG(LogChaos, Warning, TEXT("RestoreEvolutionRollbackState: particle %d does not match the captured state"), Index);
+			return false;
+		}
+	}
+
+	// Transforms and velocities are independent per particle
+	TArray<int8> CapturedObjectStates;
+	CapturedObjectStates.SetNumUninitialized(Handles.Num());
+	PhysicsParallelFor(Handles.Num(), [&](int32 Index)
+	{
+		TGeometryParticleHandle<FReal, 3>* Handle = Handles[Index];
+		TPBDRigidParticleHandle<FReal, 3>* Rigid = Handle->CastToRigidParticle();
+		TKinematicGeometryParticleHandle<FReal, 3>* Kinematic = Handle->CastToKinematicParticle();
+		const uint8* Cursor = Records + Index * RollbackState::RecordSize + sizeof(uint64);
+		RollbackState::Read(Cursor, CapturedObjectStates[Index]);
+		RollbackState::Read(Cursor, Handle->X());
+		RollbackState::Read(Cursor, Handle->R());
+		if (Rigid)
+		{
+			RollbackState::Read(Cursor, Rigid->P());
+			RollbackState::Read(Cursor, Rigid->Q());
+		}
+		else
+		{
+			Cursor += sizeof(FVec3) + sizeof(FRotation3);
+		}
+		if (Kinematic)
+		{
+			RollbackState::Read(Cursor, Kinematic->V());
+			RollbackState::Read(Cursor, Kinematic->W());
+		}
+		else
+		{
+			Cursor += 2 * sizeof(FVec3);
+		}
+		if (TPBDRigidClusteredParticleHandle<FReal, 3>* Clustered = Rigid ? Rigid->CastToClustered() : nullptr)
+		{
+			FReal Strain;
+			RollbackState::Read(Cursor, Strain);
+			Clustered->SetStrain(Strain);
+		}
+	});
+
+	// Sleep state changes move particles between the SOA views and the acceleration structure update is not thread
+	// safe, so these run serially in particle order.
+	for (int32 Index = 0; Index < Handles.Num(); ++Index)
+	{
+		TGeometryParticleHandle<FReal, 3>* Handle = Handles[Index];
+		TPBDRigidParticleHandle<FReal, 3>* Rigid = Handle->CastToRigidParticle();
+		if (Rigid && CapturedObjectStates[Index] != (int8)Rigid->ObjectState())
+		{
+			Evolution.SetParticleObjectState(Rigid, (EObjectStateType)CapturedObjectStates[Index]);
+		}
+		Evolution.DirtyParticle(*Handle);
+	}
+
+	return true;
+}
+
+// Deltas are a list of (skip, literal count, literals) runs over State XOR Base, so the bytes of particles that did not
+// change between two captures (sleeping or static ones) cost nothing but the run headers around them.
+namespace RollbackState
+{
+	static const int32 MaxRunLength = MAX_uint16;
+
+	FORCEINLINE uint8 BaseByte(const TArray<uint8>& Base, const int32 Index)
+	{
+		return Index < Base.Num() ? Base[Index] : 0;
+	}
+}
+
+void EncodeEvolutionRollbackDelta(const TArray<uint8>& Base, const TArray<uint8>& State, TArray<uint8>& OutDelta)
+{
+	OutDelta.Reset();
+	const int32 StateSize = State.Num();
+	OutDelta.Append((const uint8*)&StateSize, sizeof(StateSize));
+
+	int32 Index = 0;
+	while (Index < StateSize)
+	{
+		uint16 Skip = 0;
+		while (Index < StateSize && Skip < RollbackState::MaxRunLength && State[Index] == RollbackState::BaseByte(Base, Index))
+		{
+			++Skip;
+			++Index;
+		}
+
+		const int32 LiteralStart = Index;
+		uint16 NumLiterals = 0;
+		while (Index < StateSize && NumLiterals < RollbackState::MaxRunLength && State[Index] != RollbackState::BaseByte(Base, Index))
+		{
+			++NumLiterals;
+			++Index;
+		}
+
+		OutDelta.Append((const uint8*)&Skip, sizeof(Skip));
+		OutDelta.Append((const uint8*)&NumLiterals, sizeof(NumLiterals));
+		for (int32 Literal = LiteralStart; Literal < LiteralStart + NumLiterals; ++Literal)
+		{
+			OutDelta.Add(State[Literal] ^ RollbackState::BaseByte(Base, Literal));
+		}
+	}
+}
+
+bool DecodeEvolutionRollbackDelta(const TArray<uint8>& Base, const TArray<uint8>& Delta, TArray<uint8>& OutState)
+{
+	int32 StateSize;
+	if (Delta.Num() < (int32)sizeof(StateSize))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&StateSize, Delta.GetData(), sizeof(StateSize));
+	if (StateSize < 0)
+	{
+		return false;
+	}
+
+	OutState.SetNumUninitialized(StateSize);
+	int32 Cursor = sizeof(StateSize);
+	int32 Index = 0;
+	while (Index < StateSize)
+	{
+		uint16 Skip, NumLiterals;
+		if (Cursor + (int32)(sizeof(Skip) + sizeof(NumLiterals)) > Delta.Num())
+		{
+			return false;
+		}
+		FMemory::Memcpy(&Skip, Delta.GetData() + Cursor, sizeof(Skip));
+		FMemory::Memcpy(&NumLiterals, Delta.GetData() + Cursor + sizeof(Skip), sizeof(NumLiterals));
+		Cursor += sizeof(Skip) + sizeof(NumLiterals);
+		if (Index + Skip + NumLiterals > StateSize || Cursor + NumLiterals > Delta.Num())
+		{
+			return false;
+		}
+
+		for (const int32 End = Index + Skip; Index < End; ++Index)
+		{
+			OutState[Index] = RollbackState::BaseByte(Base, Index);
+		}
+		for (const int32 End = Index + NumLiterals; Index < End; ++Index)
+		{
+			OutState[Index] = Delta[Cursor++] ^ RollbackState::BaseByte(Base, Index);
+		}
+	}
+	return Cursor == Delta.Num();
+}
+
 void FPBDRigidsEvolutionGBF::Advance(const FReal Dt, const FReal MaxStepDt, const int32 MaxSteps)
 {
 	// Determine how many steps we would like to take
 	int32 NumSteps = FMath::CeilToInt(Dt / MaxStepDt);
+	if (NumSteps > 0 && ChaosSolverAdaptiveStepMaxDistance > 0)
+	{
+		// Take more, smaller steps when something is moving fast enough to tunnel or destabilize the solve.
+		// Clamped to MaxSteps here so that the extra steps never slow the simulation down.
+		FReal MaxSpeedSq = 0;
+		for (auto& Particle : Particles.GetActiveParticlesView())
+		{
+			if (Particle.ObjectState() == EObjectStateType::Dynamic)
+			{
+				MaxSpeedSq = FMath::Max(MaxSpeedSq, Particle.V().SizeSquared());
+			}
+		}
+		const FReal DesiredSteps = FMath::Sqrt(MaxSpeedSq) * Dt / ChaosSolverAdaptiveStepMaxDistance;
+		NumSteps = FMath::Max(NumSteps, FMath::CeilToInt(FMath::Min(DesiredSteps, (FReal)FMath::Max(MaxSteps, 1))));
+	}
+
 	if (NumSteps > 0)
 	{
 		// Determine the step time
@@ -123,15 +638,36 @@ void FPBDRigidsEvolutionGBF::Advance(const FReal Dt, const FReal MaxStepDt, cons
 		// but that is preferable to blowing up from a large timestep.
 		NumSteps = FMath::Clamp(NumSteps, 1, MaxSteps);
 
+		const double StartTime = FPlatformTime::Seconds();
 		for (int32 Step = 0; Step < NumSteps; ++Step)
 		{
 			// StepFraction: how much of the remaining time this step represents, used to interpolate kinematic targets
 			// E.g., for 4 steps this will be: 1/4, 1/3, 1/2, 1
-			const float StepFraction = (FReal)1 / (FReal)(NumSteps - Step);
+			float StepFraction = (FReal)1 / (FReal)(NumSteps - Step);
+
+			// If the steps so far suggest the next one won't fit in the budget, make this the final step
+			bool bFinalStep = false;
+			if (ChaosSolverStepTimeBudgetMs > 0 && Step > 0 && Step < NumSteps - 1)
+			{
+				const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+				const double PredictedMs = ElapsedMs * (double)(Step + 1) / (double)Step;
+				if (PredictedMs > ChaosSolverStepTimeBudgetMs)
+				{
+					UE_LOG(LogChaos, Verbose, TEXT("Advance over budget (%.2fms predicted, %.2fms budget), skipping %d of %d steps"), PredictedMs, ChaosSolverStepTimeBudgetMs, NumSteps - Step - 1, NumSteps);
+					CSV_CUSTOM_STAT(ChaosEvolution, NumSkippedSteps, NumSteps - Step - 1, ECsvCustomStatOp::Set);
+					StepFraction = 1.f;
+					bFinalStep = true;
+				}
+			}
 		
 			UE_LOG(LogChaos, Verbose, TEXT("Advance dt = %f [%d/%d]"), StepDt, Step + 1, NumSteps);
 
 			AdvanceOneTimeStep(StepDt, StepFraction);
+
+			if (bFinalStep)
+			{
+				break;
+			}
 		}
 	}
 }
@@ -223,16 +759,98 @@ bool RequiresCCDHack(FReal Dt, const TTransientPBDRigidParticleHandle<FReal, 3>&
 	return false;
 }
 
+// Bounds of the particle swept from its start (X, R) to end (P, Q) transform
+TAABB<FReal, 3> ComputeCCDSweptBounds(const TTransientPBDRigidParticleHandle<FReal, 3>& Particle)
+{
+	const TAABB<FReal, 3>& LocalBounds = Particle.Geometry()->BoundingBox();
+	TAABB<FReal, 3> SweptBounds = LocalBounds.TransformedAABB(FRigidTransform3(Particle.X(), Particle.R()));
+	SweptBounds.GrowToInclude(LocalBounds.TransformedAABB(FRigidTransform3(Particle.P(), Particle.Q())));
+	return SweptBounds;
+}
+
 void CCDHack(const FReal Dt, TParticleView<TPBDRigidParticles<FReal, 3>>& ParticlesView, const ISpatialAcceleration<TAccelerationStructureHandle<FReal, 3>, FReal, 3>* SpatialAcceleration)
 {
 	if (HackCCD_EnableThreshold > 0)
 	{
+		SCOPE_CYCLE_COUNTER(STAT_Evolution_CCD);
+
+		if (!ChaosCCDParallel)
+		{
+			for (auto& Particle : ParticlesView)
+			{
+				if (RequiresCCDHack(Dt, Particle))
+				{
+					MoveToTOIHack(Dt, Particle, SpatialAcceleration);
+				}
+			}
+			return;
+		}
+
+		// Gather the fast movers and their swept bounds
+		TArray<TPair<TPBDRigidParticleHandle<FReal, 3>*, TAABB<FReal, 3>>> FastMovers;
 		for (auto& Particle : ParticlesView)
 		{
 			if (RequiresCCDHack(Dt, Particle))
+			{
+				FastMovers.Emplace(Particle.Handle(), ComputeCCDSweptBounds(Particle));
+			}
+		}
+
+		if (FastMovers.Num() == 0)
+		{
+			return;
+		}
+
+		// A fast mover only moves itself back to its TOI, but the TOI query reads the other particle's end transform.
+		// Fast movers whose swept bounds overlap another fast mover are therefore resolved serially afterwards, in
+		// particle order as before, and all others in parallel. Sort and sweep on X to find the overlaps.
+		TSet<const TPBDRigidParticleHandle<FReal, 3>*> SerialFastMovers;
+		if (FastMovers.Num() > 1)
+		{
+			TArray<int32> SortedFastMovers;
+			SortedFastMovers.SetNumUninitialized(FastMovers.Num());
+			for (int32 Index = 0; Index < FastMovers.Num(); ++Index)
+			{
+				SortedFastMovers[Index] = Index;
+			}
+			SortedFastMovers.Sort([&FastMovers](const int32 A, const int32 B) { return FastMovers[A].Value.Min()[0] < FastMovers[B].Value.Min()[0]; });
+
+			for (int32 SortedIndexA = 0; SortedIndexA < SortedFastMovers.Num(); ++SortedIndexA)
+			{
+				const TPair<TPBDRigidParticleHandle<FReal, 3>*, TAABB<FReal, 3>>& MoverA = FastMovers[SortedFastMovers[SortedIndexA]];
+				for (int32 SortedIndexB = SortedIndexA + 1; SortedIndexB < SortedFastMovers.Num(); ++SortedIndexB)
+				{
+					const TPair<TPBDRigidParticleHandle<FReal, 3>*, TAABB<FReal, 3>>& MoverB = FastMovers[SortedFastMovers[SortedIndexB]];
+					if (MoverB.Value.Min()[0] > MoverA.Value.Max()[0])
+					{
+						break;
+					}
+					if (MoverA.Value.Intersects(MoverB.Value))
+					{
+						SerialFastMovers.Add(MoverA.Key);
+						SerialFastMovers.Add(MoverB.Key);
+					}
+				}
+			}
+		}
+
+		ParticlesView.ParallelFor([&](auto& Particle, int32 Index)
+		{
+			if (RequiresCCDHack(Dt, Particle) && !SerialFastMovers.Contains(Particle.Handle()))
 			{
 				MoveToTOIHack(Dt, Particle, SpatialAcceleration);
 			}
+		});
+
+		if (SerialFastMovers.Num() > 0)
+		{
+			for (auto& Particle : ParticlesView)
+			{
+				if (SerialFastMovers.Contains(Particle.Handle()))
+				{
+					MoveToTOIHack(Dt, Particle, SpatialAcceleration);
+				}
+			}
 		}
 	}
 }
@@ -249,12 +867,27 @@ void CCDHack(const FReal Dt, TParticleView<TPBDRigidParticles<FReal, 3>>& Partic
 void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal StepFraction)
 {
 	SCOPE_CYCLE_COUNTER(STAT_Evolution_AdvanceOneTimeStep);
+	CSV_SCOPED_TIMING_STAT(ChaosEvolution, AdvanceOneTimeStep);
 
 #if !UE_BUILD_SHIPPING
 	if (SerializeEvolution)
 	{
 		SerializeToDisk(*this);
 	}
+	if (SerializeEvolutionHistory > 0)
+	{
+		CaptureToHistory(*this);
+	}
+	if (FlushEvolutionHistory)
+	{
+		FlushEvolutionHistory = 0;
+		FlushHistoryToDisk();
+	}
+	if (ReportEvolutionMemory)
+	{
+		ReportEvolutionMemory = 0;
+		ReportMemory(*this);
+	}
 #endif
 
 	{
@@ -263,6 +896,7 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_Integrate);
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, Integrate);
 		Integrate(Particles.GetActiveParticlesView(), Dt);
 	}
 
@@ -288,6 +922,7 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_DetectCollisions);
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, DetectCollisions);
 		CollisionDetector.GetBroadPhase().SetSpatialAcceleration(InternalAcceleration.Get());
 
 		CollisionStats::FStatData StatData(bPendingHierarchyDump);
@@ -309,33 +944,44 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_PrepareConstraints);
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, PrepareConstraints);
 		PrepareConstraints(Dt);
 	}
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_CreateConstraintGraph);
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, CreateConstraintGraph);
 		CreateConstraintGraph();
 	}
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_CreateIslands);
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, CreateIslands);
 		CreateIslands();
 	}
+	CSV_CUSTOM_STAT(ChaosEvolution, NumIslands, GetConstraintGraph().NumIslands(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ChaosEvolution, NumCollisionConstraints, CollisionConstraints.NumConstraints(), ECsvCustomStatOp::Set);
 
 	if (PreApplyCallback != nullptr)
 	{
 		PreApplyCallback();
 	}
 
-	TArray<bool> SleepedIslands;
+	// Per-step island bookkeeping lives on this thread's mem stack and is released when the step ends.
+	// The inner particle lists are filled from the island tasks on other threads so they stay on the heap.
+	FMemMark IslandScratchMark(FMemStack::Get());
+	TArray<bool, TMemStackAllocator<>> SleepedIslands;
 	SleepedIslands.SetNum(GetConstraintGraph().NumIslands());
-	TArray<TArray<TPBDRigidParticleHandle<FReal, 3>*>> DisabledParticles;
+	TArray<TArray<TPBDRigidParticleHandle<FReal, 3>*>, TMemStackAllocator<>> DisabledParticles;
 	DisabledParticles.SetNum(GetConstraintGraph().NumIslands());
-	SleepedIslands.SetNum(GetConstraintGraph().NumIslands());
+	// Number of islands that went to sleep or have particles to disable, so the deactivation pass can be skipped when idle
+	TAtomic<int32> NumIslandsToDeactivate(0);
 	if(Dt > 0)
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_ParallelSolve);
-		PhysicsParallelFor(GetConstraintGraph().NumIslands(), [&](int32 Island) {
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, ParallelSolve);
+		auto SolveIsland = [&](int32 Island) {
 			const TArray<TGeometryParticleHandle<FReal, 3>*>& IslandParticles = GetConstraintGraph().GetIslandParticles(Island);
+			FScopedIslandTraceEvent IslandTraceEvent(Island, IslandParticles.Num(), GetConstraintGraph().GetIslandConstraintData(Island).Num());
 
 			{
 				SCOPE_CYCLE_COUNTER(STAT_Evolution_ApplyConstraints);
@@ -371,8 +1017,9 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 				auto PBDRigid = Particle->CastToRigidParticle();
 				if(PBDRigid && PBDRigid->ObjectState() == EObjectStateType::Dynamic)
 				{
-					if (PBDRigid->AuxilaryValue(PhysicsMaterials) && PBDRigid->V().SizeSquared() < PBDRigid->AuxilaryValue(PhysicsMaterials)->DisabledLinearThreshold &&
-						PBDRigid->W().SizeSquared() < PBDRigid->AuxilaryValue(PhysicsMaterials)->DisabledAngularThreshold)
+					const FChaosPhysicsMaterial* PhysicsMaterial = PBDRigid->AuxilaryValue(PhysicsMaterials).Get();
+					if (PhysicsMaterial && PBDRigid->V().SizeSquared() < PhysicsMaterial->DisabledLinearThreshold &&
+						PBDRigid->W().SizeSquared() < PhysicsMaterial->DisabledAngularThreshold)
 					{
 						++PBDRigid->AuxilaryValue(ParticleDisableCount);
 					}
@@ -397,7 +1044,50 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 
 			// Turn off if not moving
 			SleepedIslands[Island] = GetConstraintGraph().SleepInactive(Island, PhysicsMaterials);
-		});
+
+			if (SleepedIslands[Island] || (DisabledParticles[Island].Num() > 0))
+			{
+				++NumIslandsToDeactivate;
+			}
+		};
+
+		const int32 NumIslands = GetConstraintGraph().NumIslands();
+		if (ChaosSolverIslandCostScheduling && NumIslands > 1)
+		{
+			// Longest-processing-time-first: rank islands by estimated solve cost so the large islands start immediately
+			// and the small ones fill in around them. Oversized islands still fan out internally over their color batches
+			// (see TPBDCollisionConstraints::Apply), so starting them first lets that nested work overlap with the rest.
+			TArray<TPair<int32, int32>> IslandCosts;
+			IslandCosts.Reserve(NumIslands);
+			for (int32 Island = 0; Island < NumIslands; ++Island)
+			{
+				const int32 NumIslandConstraints = GetConstraintGraph().GetIslandConstraintData(Island).Num();
+				const int32 NumIslandParticles = GetConstraintGraph().GetIslandParticles(Island).Num();
+				IslandCosts.Emplace(NumIslandConstraints * FMath::Max(NumIterations, 1) + NumIslandParticles, Island);
+			}
+			// Break ties on island index so the ordering is stable frame to frame
+			IslandCosts.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+			{
+				return (A.Key != B.Key) ? (A.Key > B.Key) : (A.Value < B.Value);
+			});
+
+			// Each worker pulls the next most expensive island from the shared queue until it is drained. A worker that is
+			// stuck on a big island never holds back the remaining small ones, which ParallelFor's fixed blocks would do.
+			// Islands are independent so the results do not depend on which worker solved them.
+			const int32 NumWorkers = FMath::Min(NumIslands, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+			TAtomic<int32> NextIslandCost(0);
+			PhysicsParallelFor(NumWorkers, [&](int32 Worker)
+			{
+				for (int32 CostIndex = NextIslandCost++; CostIndex < NumIslands; CostIndex = NextIslandCost++)
+				{
+					SolveIsland(IslandCosts[CostIndex].Value);
+				}
+			});
+		}
+		else
+		{
+			PhysicsParallelFor(NumIslands, SolveIsland);
+		}
 	}
 
 	{
@@ -407,15 +1097,31 @@ void FPBDRigidsEvolutionGBF::AdvanceOneTimeStep(const FReal Dt, const FReal Step
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_Evolution_DeactivateSleep);
-		for (int32 Island = 0; Island < GetConstraintGraph().NumIslands(); ++Island)
+		CSV_SCOPED_TIMING_STAT(ChaosEvolution, DeactivateSleep);
+		CSV_CUSTOM_STAT(ChaosEvolution, NumIslandsToDeactivate, NumIslandsToDeactivate.Load(), ECsvCustomStatOp::Set);
+		if (NumIslandsToDeactivate.Load() > 0)
 		{
-			if (SleepedIslands[Island])
-			{
-				Particles.DeactivateParticles(GetConstraintGraph().GetIslandParticles(Island));
-			}
-			for (const auto Particle : DisabledParticles[Island])
+			// Consecutive sleeping islands are deactivated in one call rather than one call per island. The batch is flushed
+			// before any particle disable, so particles are still deactivated and disabled island by island in island order.
+			TArray<TGeometryParticleHandle<FReal, 3>*> SleepingParticles;
+			for (int32 Island = 0; Island < GetConstraintGraph().NumIslands(); ++Island)
 			{
-				DisableParticle(Particle);
+				if (SleepedIslands[Island])
+				{
+					SleepingParticles.Append(GetConstraintGraph().GetIslandParticles(Island));
+				}
+				if ((DisabledParticles[Island].Num() > 0) || (Island == GetConstraintGraph().NumIslands() - 1))
+				{
+					if (SleepingParticles.Num() > 0)
+					{
+						Particles.DeactivateParticles(SleepingParticles);
+						SleepingParticles.Reset();
+					}
+					for (const auto Particle : DisabledParticles[Island])
+					{
+						DisableParticle(Particle);
+					}
+				}
 			}
 		}
 	}
@@ -0,0 +1,32 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "Chaos/Core.h"
+
+namespace Chaos
+{
+	class FPBDRigidsEvolutionGBF;
+
+	/**
+	 * In-memory rollback of the per-step rigid state of an evolution, for rolling back and resimulating a few frames.
+	 * Defined in PBDRigidsEvolutionGBF.cpp.
+	 *
+	 * Captured per non-disabled particle: X, R, P, Q, V, W (kinematic and dynamic), object state and cluster strain.
+	 * Not captured: the island sleep counters, the per-particle disable counters, collision constraints and manifolds,
+	 * and joint and spring solver state. Constraints are rebuilt from the restored transforms on the next step, so a
+	 * resimulation only matches the original run once those counters and contacts agree again, not bit for bit.
+	 *
+	 * Captures are tied to the evolution and process that made them: particles are matched by handle address, and a
+	 * particle replaced at the same address between capture and restore is not detected.
+	 */
+	CHAOS_API void CaptureEvolutionRollbackState(FPBDRigidsEvolutionGBF& Evolution, TArray<uint8>& OutState);
+
+	/** Restore a capture. Returns false, without changing anything, if the particles no longer match the capture. */
+	CHAOS_API bool RestoreEvolutionRollbackState(FPBDRigidsEvolutionGBF& Evolution, const TArray<uint8>& State);
+
+	/** Encode State as a delta against an earlier capture Base. Decoding OutDelta against the same Base gives State back. */
+	CHAOS_API void EncodeEvolutionRollbackDelta(const TArray<uint8>& Base, const TArray<uint8>& State, TArray<uint8>& OutDelta);
+
+	/** Rebuild a capture from Base and a delta made by EncodeEvolutionRollbackDelta. Returns false if Delta is malformed. */
+	CHAOS_API bool DecodeEvolutionRollbackDelta(const TArray<uint8>& Base, const TArray<uint8>& Delta, TArray<uint8>& OutState);
+}
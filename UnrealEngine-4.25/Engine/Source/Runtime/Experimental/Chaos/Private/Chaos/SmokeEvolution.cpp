@@ -13,22 +13,42 @@ void TSmokeEvolution<T, d>::AdvanceOneTimeStep(const T Dt)
 
 	TArrayFaceND<T, d> VelocityN = MVelocity.Copy();
 	TArrayND<T, d> DensityN = MDensity.Copy();
-	PhysicsParallelFor(MGrid.GetNumCells(), [&](int32 Index) {
-		auto CellIndex = MGrid.GetIndex(Index);
-		MAdvectionRule(MGrid, MDensity, DensityN, VelocityN, Dt, CellIndex);
-	});
+
+	// Density advection and the convection of every velocity component only
+	// read the previous state, so they share a single fork/join over the grid
+	// cells followed by the concatenated dual grid cells.
+	TArray<TUniformGrid<T, d>> DualGrids;
+	DualGrids.Reserve(d);
+	int32 DualCellOffsets[d + 1];
+	DualCellOffsets[0] = 0;
 	for (int32 i = 0; i < d; ++i)
 	{
 		TVector<T, d> HalfDx = TVector<T, d>::AxisVector(i) * (MGrid.Dx()[i] / 2);
-		TUniformGrid<T, d> DualGrid(MGrid.MinCorner() - HalfDx, MGrid.MaxCorner() + HalfDx, MGrid.Counts() + TVector<int32, d>::AxisVector(i));
-		PhysicsParallelFor(DualGrid.GetNumCells(), [&](int32 Index) {
-			auto CellIndex = DualGrid.GetIndex(Index);
-			MConvectionRule(DualGrid, MVelocity.GetComponent(i), VelocityN.GetComponent(i), VelocityN, Dt, CellIndex);
-		});
+		DualGrids.Emplace(MGrid.MinCorner() - HalfDx, MGrid.MaxCorner() + HalfDx, MGrid.Counts() + TVector<int32, d>::AxisVector(i));
+		DualCellOffsets[i + 1] = DualCellOffsets[i] + DualGrids[i].GetNumCells();
 	}
+	const int32 NumCells = MGrid.GetNumCells();
+	PhysicsParallelFor(NumCells + DualCellOffsets[d], [&](int32 Index) {
+		if (Index < NumCells)
+		{
+			auto CellIndex = MGrid.GetIndex(Index);
+			MAdvectionRule(MGrid, MDensity, DensityN, VelocityN, Dt, CellIndex);
+			return;
+		}
+		Index -= NumCells;
+		int32 i = 0;
+		while (Index >= DualCellOffsets[i + 1])
+		{
+			++i;
+		}
+		const TUniformGrid<T, d>& DualGrid = DualGrids[i];
+		auto CellIndex = DualGrid.GetIndex(Index - DualCellOffsets[i]);
+		MConvectionRule(DualGrid, MVelocity.GetComponent(i), VelocityN.GetComponent(i), VelocityN, Dt, CellIndex);
+	});
+
 	PhysicsParallelFor(MGrid.GetNumFaces(), [&](int32 Index) {
 		auto FaceIndex = MGrid.GetFaceIndex(Index);
-		for (auto ForceRule : MForceRules)
+		for (const auto& ForceRule : MForceRules)
 		{
 			ForceRule(MGrid, MVelocity, Dt, FaceIndex);
 		}
@@ -1,11 +1,87 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 #include "Chaos/SpatialHash.h"
 #include "ProfilingDebugging/ScopedTimers.h"
+#include "Chaos/Framework/Parallel.h"
 
 namespace Chaos
 {
 	DEFINE_LOG_CATEGORY_STATIC(LogChaosSpatialHash, Verbose, All);
 
+	int32 SpatialHashParallelBuildMinParticles = 1024;
+	FAutoConsoleVariableRef CVarSpatialHashParallelBuildMinParticles(TEXT("p.SpatialHash.ParallelBuildMinParticles"), SpatialHashParallelBuildMinParticles, TEXT("Minimum number of particles before TSpatialHash computes particle cells in parallel [def:1024]"));
+
+	// Two pass build: compute every particle's cell (in parallel), count the cell sizes, then fill each cell list with a single allocation
+	template<class T, typename FHashFunction>
+	void BuildSpatialHashTable(const TArray<TVector<T, 3>>& Particles, const int32 NumCells, TMap<int32, TArray<int32>>& HashTable, const FHashFunction& HashFunction)
+	{
+		const int32 NumParticles = Particles.Num();
+		TArray<int32> ParticleCells;
+		ParticleCells.SetNumUninitialized(NumParticles);
+		PhysicsParallelFor(NumParticles, [&](int32 IdxParticle)
+		{
+			ParticleCells[IdxParticle] = HashFunction(Particles[IdxParticle]);
+		}, NumParticles < SpatialHashParallelBuildMinParticles);
+
+		TMap<int32, int32> CellCounts;
+		for (const int32 HashTableIdx : ParticleCells)
+		{
+			ensure(HashTableIdx < NumCells);
+			++CellCounts.FindOrAdd(HashTableIdx);
+		}
+
+		HashTable.Reserve(CellCounts.Num());
+		for (const TPair<int32, int32>& CellCount : CellCounts)
+		{
+			HashTable.FindOrAdd(CellCount.Key).Reserve(CellCount.Value);
+		}
+
+		for (int32 IdxParticle = 0; IdxParticle < NumParticles; ++IdxParticle)
+		{
+			HashTable.FindChecked(ParticleCells[IdxParticle]).Add(IdxParticle);
+		}
+	}
+
+	// Visit the cells on the surface of the (2N+1)^3 block around a cell, skipping the interior
+	template<typename FCellFunction>
+	void ForEachCellInRing(const int32 ParticleXIndex, const int32 ParticleYIndex, const int32 ParticleZIndex, const int32 N, const int32 NumberOfCellsX, const int32 NumberOfCellsY, const int32 NumberOfCellsZ, const FCellFunction& CellFunction)
+	{
+		if (N == 0)
+		{
+			CellFunction(ParticleXIndex, ParticleYIndex, ParticleZIndex);
+			return;
+		}
+
+		for (int32 XIdx = -N; XIdx <= N; ++XIdx)
+		{
+			const int32 XIndex = ParticleXIndex + XIdx;
+			if (XIndex < 0 || XIndex >= NumberOfCellsX)
+			{
+				continue;
+			}
+
+			for (int32 YIdx = -N; YIdx <= N; ++YIdx)
+			{
+				const int32 YIndex = ParticleYIndex + YIdx;
+				if (YIndex < 0 || YIndex >= NumberOfCellsY)
+				{
+					continue;
+				}
+
+				//away from the x and y faces only the two z faces are on the ring
+				const bool bOnXYFace = XIdx == N || XIdx == -N || YIdx == N || YIdx == -N;
+				const int32 ZStep = bOnXYFace ? 1 : 2 * N;
+				for (int32 ZIdx = -N; ZIdx <= N; ZIdx += ZStep)
+				{
+					const int32 ZIndex = ParticleZIndex + ZIdx;
+					if (ZIndex >= 0 && ZIndex < NumberOfCellsZ)
+					{
+						CellFunction(XIndex, YIndex, ZIndex);
+					}
+				}
+			}
+		}
+	}
+
 
 	template<class T>
 	void TSpatialHash<T>::Init(const T Radius)
@@ -38,20 +114,10 @@ namespace Chaos
 		MNumberOfCellsY = FMath::CeilToInt(Extents[1] * CellSizeInv) + 1;
 		MNumberOfCellsZ = FMath::CeilToInt(Extents[2] * CellSizeInv) + 1;
 
-		for (int32 IdxParticle = 0; IdxParticle < MParticles.Num(); ++IdxParticle)
+		BuildSpatialHashTable(MParticles, MNumberOfCellsX * MNumberOfCellsY * MNumberOfCellsZ, MHashTable, [this](const TVector<T, 3>& Particle)
 		{
-			int32 HashTableIdx = HashFunction(MParticles[IdxParticle]);
-			ensure(HashTableIdx < MNumberOfCellsX * MNumberOfCellsY * MNumberOfCellsZ);
-			if (MHashTable.Contains(HashTableIdx))
-			{
-				MHashTable[HashTableIdx].Add(IdxParticle);
-			}
-			else
-			{
-				MHashTable.Add(HashTableIdx);
-				MHashTable[HashTableIdx].Add(IdxParticle);
-			}
-		}
+			return HashFunction(Particle);
+		});
 
 		Timer.Stop();
 		UE_LOG(LogChaosSpatialHash, Log, TEXT("TSpatialHash<T>::Init() Time is %f"), Time);
@@ -83,20 +149,10 @@ namespace Chaos
 		MNumberOfCellsY = FMath::CeilToInt(Extents[1] * CellSizeInv) + 1;
 		MNumberOfCellsZ = FMath::CeilToInt(Extents[2] * CellSizeInv) + 1;
 
-		for (int32 IdxParticle = 0; IdxParticle < MParticles.Num(); ++IdxParticle)
+		BuildSpatialHashTable(MParticles, MNumberOfCellsX * MNumberOfCellsY * MNumberOfCellsZ, MHashTable, [this](const TVector<T, 3>& Particle)
 		{
-			int32 HashTableIdx = HashFunction(MParticles[IdxParticle]);
-			ensure(HashTableIdx < MNumberOfCellsX * MNumberOfCellsY * MNumberOfCellsZ);
-			if (MHashTable.Contains(HashTableIdx))
-			{
-				MHashTable[HashTableIdx].Add(IdxParticle);
-			}
-			else
-			{
-				MHashTable.Add(HashTableIdx);
-				MHashTable[HashTableIdx].Add(IdxParticle);
-			}
-		}
+			return HashFunction(Particle);
+		});
 
 		Timer.Stop();
 		UE_LOG(LogChaosSpatialHash, Log, TEXT("TSpatialHash<T>::Init() Time is %f"), Time);
@@ -131,41 +187,35 @@ namespace Chaos
 		double Time = 0.0;
 		FDurationTimer Timer(Time);
 
-		TSet<int32> ClosestPoints;
-		int32 MaxN = ComputeMaxN(Particle, MaxRadius);
+		// Every particle lives in exactly one cell and ring cells are unique, so points can be gathered without deduplication
+		TArray<int32> ClosestPoints;
+		const int32 MaxN = ComputeMaxN(Particle, MaxRadius);
+		const T MaxRadiusSquared = MaxRadius * MaxRadius;
 
+		int32 ParticleXIndex, ParticleYIndex, ParticleZIndex;
+		ComputeGridXYZ(Particle, ParticleXIndex, ParticleYIndex, ParticleZIndex);
 		for (int32 IdxRing = 0; IdxRing < MaxN; ++IdxRing)
 		{
-			TSet<int32> CellIndices = GetNRing(Particle, IdxRing);
-			for (auto& CellIdx : CellIndices)
+			ForEachCellInRing(ParticleXIndex, ParticleYIndex, ParticleZIndex, IdxRing, MNumberOfCellsX, MNumberOfCellsY, MNumberOfCellsZ, [&](const int32 XIndex, const int32 YIndex, const int32 ZIndex)
 			{
-				if (MHashTable.Contains(CellIdx))
+				if (const TArray<int32>* CellPoints = MHashTable.Find(HashFunction(XIndex, YIndex, ZIndex)))
 				{
-					ClosestPoints.Append(MHashTable[CellIdx]);
+					for (const int32 PointIdx : *CellPoints)
+					{
+						// Skip points which are out of MaxRadius range
+						if ((Particle - MParticles[PointIdx]).SizeSquared() <= MaxRadiusSquared)
+						{
+							ClosestPoints.Add(PointIdx);
+						}
+					}
 				}
-			}
-		}
-
-		// Need to delete points which are out of MaxRadius range
-		TSet<int32> PointsToRemove;
-		T MaxRadiusSquared = MaxRadius * MaxRadius;
-		for (auto& Elem : ClosestPoints)
-		{
-			FVector Diff = Particle - MParticles[Elem];
-			if (Diff.SizeSquared() > MaxRadiusSquared)
-			{
-				PointsToRemove.Add(Elem);
-			}
-		}
-		if (PointsToRemove.Num() > 0)
-		{
-			ClosestPoints = ClosestPoints.Difference(ClosestPoints.Intersect(PointsToRemove));
+			});
 		}
 
 		Timer.Stop();
 		UE_LOG(LogChaosSpatialHash, Log, TEXT("TSpatialHash<T>::GetClosestPoints() Time is %f"), Time);
 
-		return ClosestPoints.Array();
+		return ClosestPoints;
 	}
 
 	template<class T>
@@ -174,61 +224,46 @@ namespace Chaos
 		double Time = 0.0;
 		FDurationTimer Timer(Time);
 
-		TSet<int32> ClosestPoints;
-		int32 MaxN = ComputeMaxN(Particle, MaxRadius);
+		// Every particle lives in exactly one cell and ring cells are unique, so points can be gathered without deduplication
+		TArray<int32> ClosestPoints;
+		const int32 MaxN = ComputeMaxN(Particle, MaxRadius);
+		const T MaxRadiusSquared = MaxRadius * MaxRadius;
 
+		int32 ParticleXIndex, ParticleYIndex, ParticleZIndex;
+		ComputeGridXYZ(Particle, ParticleXIndex, ParticleYIndex, ParticleZIndex);
 		for (int32 IdxRing = 0; IdxRing < MaxN; ++IdxRing)
 		{
-			TSet<int32> CellIndices = GetNRing(Particle, IdxRing);
-			for (auto& CellIdx : CellIndices)
+			ForEachCellInRing(ParticleXIndex, ParticleYIndex, ParticleZIndex, IdxRing, MNumberOfCellsX, MNumberOfCellsY, MNumberOfCellsZ, [&](const int32 XIndex, const int32 YIndex, const int32 ZIndex)
 			{
-				if (MHashTable.Contains(CellIdx))
+				if (const TArray<int32>* CellPoints = MHashTable.Find(HashFunction(XIndex, YIndex, ZIndex)))
 				{
-					ClosestPoints.Append(MHashTable[CellIdx]);
+					for (const int32 PointIdx : *CellPoints)
+					{
+						// Skip points which are out of MaxRadius range
+						if ((Particle - MParticles[PointIdx]).SizeSquared() <= MaxRadiusSquared)
+						{
+							ClosestPoints.Add(PointIdx);
+						}
+					}
 				}
-			}
-		}
-
-		// Need to delete points which are out of MaxRadius range
-		TSet<int32> PointsToRemove;
-		T MaxRadiusSquared = MaxRadius * MaxRadius;
-		for (auto& Elem : ClosestPoints)
-		{
-			FVector Diff = Particle - MParticles[Elem];
-			if (Diff.SizeSquared() > MaxRadiusSquared)
-			{
-				PointsToRemove.Add(Elem);
-			}
-		}
-		if (PointsToRemove.Num() > 0)
-		{
-			ClosestPoints = ClosestPoints.Difference(ClosestPoints.Intersect(PointsToRemove));
+			});
 		}
 
 		// Sort ClosestPoints
-		TMap<int32, T> ParticleIdxDistanceMap;
-		for (auto& Elem : ClosestPoints)
-		{
-			TVector<T, 3> Diff = Particle - MParticles[Elem];
-			ParticleIdxDistanceMap.Add(Elem, Diff.SizeSquared());
-		}
-		ParticleIdxDistanceMap.ValueSort([](const T& Distance1, const T& Distance2) {
-			return Distance1 < Distance2;
+		ClosestPoints.Sort([this, &Particle](const int32 PointIdx1, const int32 PointIdx2) {
+			return (Particle - MParticles[PointIdx1]).SizeSquared() < (Particle - MParticles[PointIdx2]).SizeSquared();
 		});
 
-		TArray<int32> ClosestPointsArray;
-		ParticleIdxDistanceMap.GetKeys(ClosestPointsArray);
-
 		// Delete points after MaxPoints
-		if (ClosestPointsArray.Num() > MaxPoints)
+		if (ClosestPoints.Num() > MaxPoints)
 		{
-			ClosestPointsArray.SetNum(MaxPoints);
+			ClosestPoints.SetNum(MaxPoints);
 		}
 		
 		Timer.Stop();
 		UE_LOG(LogChaosSpatialHash, Log, TEXT("TSpatialHash<T>::GetClosestPoints() Time is %f"), Time);
 			
-		return ClosestPointsArray;
+		return ClosestPoints;
 	}
 
 	template<class T>
@@ -241,39 +276,28 @@ namespace Chaos
 
 		if (MBoundingBox.Contains(Particle))
 		{
-			TSet<int32> ClosestPoints;
+			int32 ParticleXIndex, ParticleYIndex, ParticleZIndex;
+			ComputeGridXYZ(Particle, ParticleXIndex, ParticleYIndex, ParticleZIndex);
 
-			int32 IdxRing = 0;
-			while (ClosestPoints.Num() < 1)
+			// Grow rings until one contains points, then keep the closest of those
+			float DistanceSquared = FLT_MAX;
+			for (int32 IdxRing = 0; ClosestPointIdx == INDEX_NONE; ++IdxRing)
 			{
-				TSet<int32> CellIndices = GetNRing(Particle, IdxRing);
-				for (auto& CellIdx : CellIndices)
+				ForEachCellInRing(ParticleXIndex, ParticleYIndex, ParticleZIndex, IdxRing, MNumberOfCellsX, MNumberOfCellsY, MNumberOfCellsZ, [&](const int32 XIndex, const int32 YIndex, const int32 ZIndex)
 				{
-					if (MHashTable.Contains(CellIdx))
+					if (const TArray<int32>* CellPoints = MHashTable.Find(HashFunction(XIndex, YIndex, ZIndex)))
 					{
-						ClosestPoints.Append(MHashTable[CellIdx]);
-					}
-				}
-
-				IdxRing++;
-			}
-
-			ClosestPointIdx = ClosestPoints.Array()[0];
-
-			// If ClosestPoints have more than one point find the closest one
-			if (ClosestPoints.Num() > 1)
-			{
-				float DistanceSquared = FLT_MAX;
-				for (auto& PointIdx : ClosestPoints)
-				{
-					FVector Diff = Particle - MParticles[PointIdx];
-					T DiffSquared = Diff.SizeSquared();
-					if (DiffSquared < DistanceSquared)
-					{
-						DistanceSquared = DiffSquared;
-						ClosestPointIdx = PointIdx;
+						for (const int32 PointIdx : *CellPoints)
+						{
+							const T DiffSquared = (Particle - MParticles[PointIdx]).SizeSquared();
+							if (DiffSquared < DistanceSquared)
+							{
+								DistanceSquared = DiffSquared;
+								ClosestPointIdx = PointIdx;
+							}
+						}
 					}
-				}
+				});
 			}
 		}
 		else
@@ -3,7 +3,9 @@
 
 #include "Chaos/Box.h"
 #include "Chaos/Defines.h"
+#include "Chaos/Framework/Parallel.h"
 #include "Chaos/Plane.h"
+#include "HAL/IConsoleManager.h"
 #include "Math/NumericLimits.h"
 #include "Math/RandomStream.h"
 #include "Templates/Sorting.h"
@@ -14,6 +16,25 @@
 
 using namespace Chaos;
 
+int32 TriangleMeshParallelMinPoints = 1024;
+FAutoConsoleVariableRef CVarTriangleMeshParallelMinPoints(TEXT("p.TriangleMeshParallelMinPoints"), TriangleMeshParallelMinPoints, TEXT("Minimum number of points (or edges) before per-point grid hashing and curvature passes in TTriangleMesh run in parallel."));
+
+/**
+ * Hash every local point to a flat grid cell index in parallel.  The cell
+ * assignment is independent per point, so only the order dependent
+ * bookkeeping that consumes \p CellIndices needs to stay serial.
+ */
+template<class T, class FCellFunction>
+static void ComputeFlatCellIndices(const TArray<TVector<T, 3>>& LocalPoints, TArray<int64>& CellIndices, const FCellFunction& CellFunction)
+{
+	const int32 NumPoints = LocalPoints.Num();
+	CellIndices.SetNumUninitialized(NumPoints);
+	PhysicsParallelFor(NumPoints, [&LocalPoints, &CellIndices, &CellFunction](int32 Idx)
+	{
+		CellIndices[Idx] = CellFunction(LocalPoints[Idx]);
+	}, NumPoints < TriangleMeshParallelMinPoints);
+}
+
 template<class T>
 TTriangleMesh<T>::TTriangleMesh()
     : MStartIdx(0)
@@ -164,12 +185,30 @@ const TMap<int32, TArray<int32>>& TTriangleMesh<T>::GetPointToTriangleMap() cons
 	{
 		return MPointToTriangleMap;
 	}
+	// Count the valence of every vertex first so that each triangle list is
+	// allocated exactly once, rather than regrowing as triangles are appended.
+	TArray<int32> Valences;
+	Valences.SetNumZeroed(MNumIndices);
+	for (const TVector<int32, 3>& Tri : MElements)
+	{
+		for (int Axis = 0; Axis < 3; ++Axis)
+		{
+			++Valences[Tri[Axis] - MStartIdx];
+		}
+	}
 	MPointToTriangleMap.Reserve(MNumIndices);
 	for (int i = 0; i < MElements.Num(); ++i)
 	{
 		for (int Axis = 0; Axis < 3; ++Axis)
 		{
-			MPointToTriangleMap.FindOrAdd(MElements[i][Axis]).Add(i);
+			const int32 PointIndex = MElements[i][Axis];
+			TArray<int32>* Triangles = MPointToTriangleMap.Find(PointIndex);
+			if (!Triangles)
+			{
+				Triangles = &MPointToTriangleMap.Add(PointIndex);
+				Triangles->Reserve(Valences[PointIndex - MStartIdx]);
+			}
+			Triangles->Add(i);
 		}
 	}
 	return MPointToTriangleMap;
@@ -187,22 +226,72 @@ TArray<TVector<int32, 2>> TTriangleMesh<T>::GetUniqueAdjacentPoints() const
 	return BendingConstraints;
 }
 
+/**
+ * Key functions for a TSet of sorted 4-vertex tuples, used to dedupe bending
+ * elements without allocating a TArray per candidate.
+ */
+struct SortedElement4KeyFuncs : BaseKeyFuncs<TVector<int32, 4>, TVector<int32, 4>, false>
+{
+	static FORCEINLINE const TVector<int32, 4>& GetSetKey(const TVector<int32, 4>& Elem)
+	{
+		return Elem;
+	}
+
+	static FORCEINLINE bool Matches(const TVector<int32, 4>& A, const TVector<int32, 4>& B)
+	{
+		return A[0] == B[0] && A[1] == B[1] && A[2] == B[2] && A[3] == B[3];
+	}
+
+	static FORCEINLINE uint32 GetKeyHash(const TVector<int32, 4>& Elem)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Elem[0]), GetTypeHash(Elem[1])), HashCombine(GetTypeHash(Elem[2]), GetTypeHash(Elem[3])));
+	}
+};
+
 template<class T>
 TArray<TVector<int32, 4>> TTriangleMesh<T>::GetUniqueAdjacentElements() const
 {
 	TArray<TVector<int32, 4>> BendingConstraints;
-	TSet<TArray<int32>> BendingElements;
+	TSet<TVector<int32, 4>, SortedElement4KeyFuncs> BendingElements;
+	BendingElements.Reserve(MElements.Num() * 3 / 2);
+	BendingConstraints.Reserve(MElements.Num() * 3 / 2);
 	GetPointToTriangleMap(); // build MPointToTriangleMap
+
+	// Neighbors of a single vertex with the triangles they share with it, in
+	// order of first occurrence.  Vertex valences are small, so a linear search
+	// over inline storage beats building a TMap per vertex.
+	typedef TPair<int32, TArray<int32, TInlineAllocator<2>>> FNeighborTriangles;
+	TArray<FNeighborTriangles, TInlineAllocator<16>> SubPointToTriangleMap;
+	auto AddNeighborTriangle = [&SubPointToTriangleMap](const int32 PointIndex, const int32 TriangleIndex)
+	{
+		for (FNeighborTriangles& Neighbor : SubPointToTriangleMap)
+		{
+			if (Neighbor.Key == PointIndex)
+			{
+				Neighbor.Value.Add(TriangleIndex);
+				return;
+			}
+		}
+		FNeighborTriangles& Neighbor = SubPointToTriangleMap.AddDefaulted_GetRef();
+		Neighbor.Key = PointIndex;
+		Neighbor.Value.Add(TriangleIndex);
+	};
+
 	for (int32 SurfaceIndex = MStartIdx; SurfaceIndex < MStartIdx + MNumIndices; ++SurfaceIndex)
 	{
-		TMap<int32, TArray<int32>> SubPointToTriangleMap;
-		for (auto TriangleIndex : MPointToTriangleMap[SurfaceIndex])
+		const TArray<int32>* SurfaceTriangles = MPointToTriangleMap.Find(SurfaceIndex);
+		if (!SurfaceTriangles)
 		{
-			SubPointToTriangleMap.FindOrAdd(MElements[TriangleIndex][0]).Add(TriangleIndex);
-			SubPointToTriangleMap.FindOrAdd(MElements[TriangleIndex][1]).Add(TriangleIndex);
-			SubPointToTriangleMap.FindOrAdd(MElements[TriangleIndex][2]).Add(TriangleIndex);
+			continue; // Unreferenced vertex
 		}
-		for (auto OtherIndex : SubPointToTriangleMap)
+		SubPointToTriangleMap.Reset();
+		for (const int32 TriangleIndex : *SurfaceTriangles)
+		{
+			AddNeighborTriangle(MElements[TriangleIndex][0], TriangleIndex);
+			AddNeighborTriangle(MElements[TriangleIndex][1], TriangleIndex);
+			AddNeighborTriangle(MElements[TriangleIndex][2], TriangleIndex);
+		}
+		for (const FNeighborTriangles& OtherIndex : SubPointToTriangleMap)
 		{
 			if (SurfaceIndex == OtherIndex.Key)
 				continue;
@@ -238,13 +327,14 @@ TArray<TVector<int32, 4>> TTriangleMesh<T>::GetUniqueAdjacentElements() const
 				Tri2Pt = MElements[Tri2][2];
 			}
 			check(Tri2Pt != -1);
-			auto BendingArray = TArray<int32>({SurfaceIndex, OtherIndex.Key, Tri1Pt, Tri2Pt});
-			BendingArray.Sort();
-			if (BendingElements.Contains(BendingArray))
+			int32 BendingArray[4] = {SurfaceIndex, OtherIndex.Key, Tri1Pt, Tri2Pt};
+			Sort(BendingArray, 4);
+			bool bAlreadyInSet = false;
+			BendingElements.Add(TVector<int32, 4>({BendingArray[0], BendingArray[1], BendingArray[2], BendingArray[3]}), &bAlreadyInSet);
+			if (bAlreadyInSet)
 			{
 				continue;
 			}
-			BendingElements.Add(BendingArray);
 			BendingConstraints.Add(TVector<int32, 4>({SurfaceIndex, OtherIndex.Key, Tri1Pt, Tri2Pt}));
 		}
 	}
@@ -405,9 +495,10 @@ void AddTrianglesToHull(const TArrayView<const TVector<T, 3>>& Points, const int
 			{
 				continue;
 			}
-			T Dist1 = NewPlane1.SignedDistance(Points[InIndices[i]]);
-			T Dist2 = NewPlane2.SignedDistance(Points[InIndices[i]]);
-			T Dist3 = NewPlane3.SignedDistance(Points[InIndices[i]]);
+			const TVector<T, 3>& Point = Points[InIndices[i]];
+			T Dist1 = NewPlane1.SignedDistance(Point);
+			T Dist2 = NewPlane2.SignedDistance(Point);
+			T Dist3 = NewPlane3.SignedDistance(Point);
 			check(Dist1 < 0 || Dist2 < 0 || Dist3 < 0);
 			if (Dist1 > 0 && Dist2 > 0)
 			{
@@ -437,12 +528,17 @@ void AddTrianglesToHull(const TArrayView<const TVector<T, 3>>& Points, const int
 		AddTrianglesToHull(Points, I0, I1, MaxD, NewPlane1, NewIndices1, OutIndices);
 		AddTrianglesToHull(Points, I0, I2, MaxD, NewPlane2, NewIndices2, OutIndices);
 		AddTrianglesToHull(Points, I1, I2, MaxD, NewPlane3, NewIndices3, OutIndices);
-		for (int32 i = 0; i < OutIndices.Num(); ++i)
+		// Scanning the whole output is only needed when this split produced faces to filter. Most splits don't,
+		// and skipping them keeps the hull build from going quadratic in the face count.
+		if (FacesToFilter.Num())
 		{
-			if (FacesToFilter.Contains(FIntVector(OutIndices[i][0], OutIndices[i][1], OutIndices[i][2])))
+			for (int32 i = 0; i < OutIndices.Num(); ++i)
 			{
-				OutIndices.RemoveAtSwap(i);
-				i--;
+				if (FacesToFilter.Contains(FIntVector(OutIndices[i][0], OutIndices[i][1], OutIndices[i][2])))
+				{
+					OutIndices.RemoveAtSwap(i);
+					i--;
+				}
 			}
 		}
 	}
@@ -528,6 +624,8 @@ TTriangleMesh<T> TTriangleMesh<T>::GetConvexHullFromParticles(const TArrayView<c
 		TArray<int32> Left;
 		TArray<int32> Right;
 		TArray<int32> Coplanar;
+		Left.Reserve(Points.Num());
+		Right.Reserve(Points.Num());
 		TSet<int32> CoplanarSet;
 		CoplanarSet.Add(MaxD);
 		CoplanarSet.Add(Index1);
@@ -538,11 +636,12 @@ TTriangleMesh<T> TTriangleMesh<T>::GetConvexHullFromParticles(const TArrayView<c
 			{
 				continue;
 			}
-			if (SplitPlane.SignedDistance(Points[Idx]) > 0)
+			const T Distance = SplitPlane.SignedDistance(Points[Idx]);
+			if (Distance > 0)
 			{
 				Left.Add(Idx);
 			}
-			else if (SplitPlane.SignedDistance(Points[Idx]) < 0)
+			else if (Distance < 0)
 			{
 				Right.Add(Idx);
 			}
@@ -650,6 +749,28 @@ TSegmentMesh<T>& TTriangleMesh<T>::GetSegmentMesh()
 	TArray<TVector<int32, 2>> UniqueEdges;
 	UniqueEdges.Reserve(MElements.Num() * 3);
 
+	// Searching the whole of UniqueEdges for every half edge is quadratic, so
+	// bucket the unique edges by their lower vertex in a compressed (CSR) layout.
+	// Each lookup then only scans the few edges sharing that vertex.  Edges are
+	// still numbered in order of first occurrence.
+	TArray<int32> EdgeBucketOffsets;
+	EdgeBucketOffsets.SetNumZeroed(MNumIndices + 1);
+	for (const TVector<int32, 3>& Tri : MElements)
+	{
+		for (int32 j = 0; j < 3; j++)
+		{
+			++EdgeBucketOffsets[FMath::Min(Tri[j], Tri[(j + 1) % 3]) - MStartIdx + 1];
+		}
+	}
+	for (int32 i = 1; i <= MNumIndices; i++)
+	{
+		EdgeBucketOffsets[i] += EdgeBucketOffsets[i - 1];
+	}
+	TArray<int32> EdgeBucketCounts;
+	EdgeBucketCounts.SetNumZeroed(MNumIndices);
+	TArray<int32> EdgeBuckets;
+	EdgeBuckets.SetNumUninitialized(MElements.Num() * 3);
+
 	MEdgeToFaces.Reset();
 	MEdgeToFaces.Reserve(MElements.Num() * 3); // over estimate
 	MFaceToEdges.Reset();
@@ -662,7 +783,25 @@ TSegmentMesh<T>& TTriangleMesh<T>::GetSegmentMesh()
 		{
 			TVector<int32, 2> Edge(Tri[j], Tri[(j + 1) % 3]);
 
-			const int32 EdgeIdx = UniqueEdges.AddUnique(GetOrdered(Edge));
+			const TVector<int32, 2> OrderedEdge = GetOrdered(Edge);
+			const int32 Bucket = OrderedEdge[0] - MStartIdx;
+			const int32 BucketStart = EdgeBucketOffsets[Bucket];
+			const int32 BucketEnd = BucketStart + EdgeBucketCounts[Bucket];
+			int32 EdgeIdx = INDEX_NONE;
+			for (int32 k = BucketStart; k < BucketEnd; k++)
+			{
+				if (UniqueEdges[EdgeBuckets[k]][1] == OrderedEdge[1])
+				{
+					EdgeIdx = EdgeBuckets[k];
+					break;
+				}
+			}
+			if (EdgeIdx == INDEX_NONE)
+			{
+				EdgeIdx = UniqueEdges.Add(OrderedEdge);
+				EdgeBuckets[BucketEnd] = EdgeIdx;
+				++EdgeBucketCounts[Bucket];
+			}
 			EdgeIds[j] = EdgeIdx;
 
 			// Track which faces are shared by edges.
@@ -796,8 +935,11 @@ TMap<int32, int32> TTriangleMesh<T>::FindCoincidentVertexRemappings(
 	// Find coincident vertices.
 	// We hash to a grid of fine enough resolution such that if 2 particles 
 	// hash to the same cell, then we're going to consider them coincident.
-	TMap<int64, TSet<int32>> OccupiedCells;
+	// Each cell only needs to remember the first vertex that landed in it;
+	// every later vertex in that cell is remapped to it.
+	TMap<int64, int32> OccupiedCells;
 	OccupiedCells.Reserve(NumPoints);
+	TArray<int64> CellIndices;
 
 	const int64 Resolution = static_cast<int64>(floor(MaxBBoxDim / 0.01));
 	const T CellSize = MaxBBoxDim / Resolution;
@@ -809,6 +951,15 @@ TMap<int32, int32> TTriangleMesh<T>::FindCoincidentVertexRemappings(
 		// we don't miss slightly adjacent coincident points across cell
 		// boundaries.
 		const TVector<T, 3> GridCenter = LocalCenter - TVector<T, 3>(i * CellSize / 2);
+		ComputeFlatCellIndices(LocalPoints, CellIndices, [&GridCenter, CellSize, Resolution](const TVector<T, 3>& Pos)
+		{
+			const TVector<int64, 3> Coord(
+				static_cast<int64>(floor((Pos[0] - GridCenter[0]) / CellSize + Resolution / 2)),
+				static_cast<int64>(floor((Pos[1] - GridCenter[1]) / CellSize + Resolution / 2)),
+				static_cast<int64>(floor((Pos[2] - GridCenter[2]) / CellSize + Resolution / 2)));
+			return ((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
+		});
+
 		for (int32 LocalIdx = 0; LocalIdx < NumPoints; LocalIdx++)
 		{
 			const int32 Idx = TestIndices[LocalIdx];
@@ -818,36 +969,17 @@ TMap<int32, int32> TTriangleMesh<T>::FindCoincidentVertexRemappings(
 				continue;
 			}
 
-			const TVector<T, 3>& Pos = LocalPoints[LocalIdx];
-			const TVector<int64, 3> Coord(
-				static_cast<int64>(floor((Pos[0] - GridCenter[0]) / CellSize + Resolution / 2)),
-				static_cast<int64>(floor((Pos[1] - GridCenter[1]) / CellSize + Resolution / 2)),
-				static_cast<int64>(floor((Pos[2] - GridCenter[2]) / CellSize + Resolution / 2)));
-			const int64 FlatIdx =
-				((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
-
-			TSet<int32>& Bucket = OccupiedCells.FindOrAdd(FlatIdx);
-			Bucket.Add(Idx);
-		}
-
-		// Iterate over all occupied cells and remap redundant vertices to the first index.
-		for (auto& KV : OccupiedCells)
-		{
-			const TSet<int32>& CoincidentVertices = KV.Value;
-			if (CoincidentVertices.Num() <= 1)
-				continue;
-			int32 First = INDEX_NONE;
-			for (const int32 Idx : CoincidentVertices)
+			if (const int32* First = OccupiedCells.Find(CellIndices[LocalIdx]))
 			{
-				if (First == INDEX_NONE)
-				{
-					First = Idx;
-				}
-				else
+				if (*First != Idx)
 				{
-					Remappings.Add(Idx, First);
+					Remappings.Add(Idx, *First);
 				}
 			}
+			else
+			{
+				OccupiedCells.Add(CellIndices[LocalIdx], Idx);
+			}
 		}
 	}
 
@@ -862,9 +994,10 @@ TArray<T> TTriangleMesh<T>::GetCurvatureOnEdges(const TArray<TVector<T, 3>>& Fac
 	const TSegmentMesh<T>& SegmentMesh = GetSegmentMesh(); // builds MEdgeToFaces
 	TArray<T> EdgeAngles;
 	EdgeAngles.SetNumZeroed(MEdgeToFaces.Num());
-	for (int32 EdgeId = 0; EdgeId < MEdgeToFaces.Num(); EdgeId++)
+	const TArray<TVector<int32, 2>>& EdgeToFaces = MEdgeToFaces;
+	PhysicsParallelFor(EdgeToFaces.Num(), [&EdgeToFaces, &FaceNormals, &EdgeAngles, NumNormals](int32 EdgeId)
 	{
-		const TVector<int32, 2>& FaceIds = MEdgeToFaces[EdgeId];
+		const TVector<int32, 2>& FaceIds = EdgeToFaces[EdgeId];
 		if (FaceIds[0] >= 0 &&
 		    FaceIds[1] >= 0 && // -1 is sentinel, which denotes a boundary edge.
 		    FaceIds[0] < NumNormals &&
@@ -874,7 +1007,7 @@ TArray<T> TTriangleMesh<T>::GetCurvatureOnEdges(const TArray<TVector<T, 3>>& Fac
 			const TVector<T, 3>& Norm2 = FaceNormals[FaceIds[1]];
 			EdgeAngles[EdgeId] = TVector<T, 3>::AngleBetween(Norm1, Norm2);
 		}
-	}
+	}, EdgeToFaces.Num() < TriangleMeshParallelMinPoints);
 	return EdgeAngles;
 }
 
@@ -1087,10 +1220,10 @@ TArray<int32> TTriangleMesh<T>::GetVertexImportanceOrdering(
 	// Send points that are the furthest away to the front of the list.
 	TArray<T> Dist;
 	Dist.AddUninitialized(NumPoints);
-	for (int i = 0; i < NumPoints; i++)
+	PhysicsParallelFor(NumPoints, [&Dist, &LocalPoints, &LocalCenter](int32 i)
 	{
 		Dist[i] = (LocalPoints[i] - LocalCenter).SizeSquared();
-	}
+	}, NumPoints < TriangleMeshParallelMinPoints);
 	DescendingPredicate<T> DescendingDistPred(Dist); // high to low
 	StableSort(&PointOrder[0], NumPoints, DescendingDistPred);
 
@@ -1116,6 +1249,7 @@ TArray<int32> TTriangleMesh<T>::GetVertexImportanceOrdering(
 		CoincidentVertices->Reserve(64); // a guess
 	}
 	int32 NumCoincident = 0;
+	TArray<int64> CellIndices;
 	{
 		const int64 Resolution = static_cast<int64>(floor(MaxBBoxDim / 0.01));
 		const T CellSize = MaxBBoxDim / Resolution;
@@ -1128,20 +1262,23 @@ TArray<int32> TTriangleMesh<T>::GetVertexImportanceOrdering(
 			// we don't miss slightly adjacent coincident points across cell
 			// boundaries.
 			const TVector<T, 3> GridCenter = LocalCenter - TVector<T, 3>(i * CellSize / 2);
-			const int NumCoincidentPrev = NumCoincident;
-			for (int j = 0; j < NumPoints - NumCoincidentPrev; j++)
+			ComputeFlatCellIndices(LocalPoints, CellIndices, [&GridCenter, CellSize, Resolution](const TVector<T, 3>& Pos)
 			{
-				const int32 Idx = PointOrder[j];
-				const TVector<T, 3>& Pos = LocalPoints[Idx - Offset];
 				const TVector<int64, 3> Coord(
 				    static_cast<int64>(floor((Pos[0] - GridCenter[0]) / CellSize + Resolution / 2)),
 				    static_cast<int64>(floor((Pos[1] - GridCenter[1]) / CellSize + Resolution / 2)),
 				    static_cast<int64>(floor((Pos[2] - GridCenter[2]) / CellSize + Resolution / 2)));
-				const int64 FlatIdx =
-				    ((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
+				return ((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
+			});
 
+			// Cell assignment is done up front; which point claims a cell
+			// first depends on PointOrder, so that part stays serial.
+			const int NumCoincidentPrev = NumCoincident;
+			for (int j = 0; j < NumPoints - NumCoincidentPrev; j++)
+			{
+				const int32 Idx = PointOrder[j];
 				bool AlreadyInSet = false;
-				OccupiedCells.Add(FlatIdx, &AlreadyInSet);
+				OccupiedCells.Add(CellIndices[Idx - Offset], &AlreadyInSet);
 				if (AlreadyInSet)
 				{
 					Rank[Idx - Offset] = 1;
@@ -1172,23 +1309,23 @@ TArray<int32> TTriangleMesh<T>::GetVertexImportanceOrdering(
 		check(Resolution > 0);
 		check(Resolution % 2 == 0);
 		const T CellSize = MaxBBoxDim / Resolution;
-
-		// The order in which we process these points matters.  Must do
-		// the current highest rank first.
-		for (int j = 0; j < NumPoints - NumCoincident; j++)
+		ComputeFlatCellIndices(LocalPoints, CellIndices, [&LocalCenter, CellSize, Resolution](const TVector<T, 3>& Pos)
 		{
-			const int32 Idx = PointOrder[j];
-			const TVector<T, 3>& Pos = LocalPoints[Idx - Offset];
 			// grid center co-located at bbox center:
 			const TVector<int64, 3> Coord(
 			    static_cast<int64>(floor((Pos[0] - LocalCenter[0]) / CellSize)) + Resolution / 2,
 			    static_cast<int64>(floor((Pos[1] - LocalCenter[1]) / CellSize)) + Resolution / 2,
 			    static_cast<int64>(floor((Pos[2] - LocalCenter[2]) / CellSize)) + Resolution / 2);
-			const int64 FlatIdx =
-			    ((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
+			return ((Coord[0] * Resolution + Coord[1]) * Resolution) + Coord[2];
+		});
 
+		// The order in which we process these points matters.  Must do
+		// the current highest rank first.
+		for (int j = 0; j < NumPoints - NumCoincident; j++)
+		{
+			const int32 Idx = PointOrder[j];
 			bool AlreadyInSet = false;
-			OccupiedCells.Add(FlatIdx, &AlreadyInSet);
+			OccupiedCells.Add(CellIndices[Idx - Offset], &AlreadyInSet);
 			Rank[Idx - Offset] = AlreadyInSet ? 1 : 0;
 		}
 
@@ -69,6 +69,37 @@ void TransformSweepOutputsHelper(FVec3 TriMeshScale, const TVec3<FReal>& HitNorm
 	}
 }
 
+// Is a point on the triangle's plane within Epsilon of the triangle.
+// Most candidates are clearly inside or clearly outside one of the edges, only the thin band around the border needs the closest point search.
+static bool IsPlanePointNearTriangle(const FVec3& Point, const FVec3& A, const FVec3& B, const FVec3& C, const FVec3& TriNormal, const FReal Epsilon2)
+{
+	const FVec3 Edges[3] = { B - A, C - B, A - C };
+	const FVec3* EdgeStarts[3] = { &A, &B, &C };
+
+	bool bInside = true;
+	for (int32 EdgeIdx = 0; EdgeIdx < 3; ++EdgeIdx)
+	{
+		//positive on the triangle's side of the edge, scaled by the edge length
+		const FReal Side = FVec3::DotProduct(FVec3::CrossProduct(Edges[EdgeIdx], Point - *EdgeStarts[EdgeIdx]), TriNormal);
+		if (Side < 0)
+		{
+			if (Side * Side > Epsilon2 * Edges[EdgeIdx].SizeSquared())
+			{
+				return false;
+			}
+			bInside = false;
+		}
+	}
+
+	if (bInside)
+	{
+		return true;
+	}
+
+	const FVec3 ClosestPtOnTri = FindClosestPointOnTriangle(Point, A, B, C, Point);
+	return (Point - ClosestPtOnTri).SizeSquared() <= Epsilon2;
+}
+
 template <typename IdxType>
 struct FTriangleMeshRaycastVisitor
 {
@@ -151,9 +182,8 @@ struct FTriangleMeshRaycastVisitor
 			}
 			else
 			{
-				const FVec3 ClosestPtOnTri = FindClosestPointOnTriangle(RaycastPosition, A, B, C, RaycastPosition);	//We know Position is on the triangle plane
-				const FReal DistToTriangle2 = (RaycastPosition - ClosestPtOnTri).SizeSquared();
-				bTriangleIntersects = DistToTriangle2 <= Epsilon2;	//raycast gave us the intersection point so sphere radius is already accounted for
+				//We know Position is on the triangle plane
+				bTriangleIntersects = IsPlanePointNearTriangle(RaycastPosition, A, B, C, TriNormal, Epsilon2);	//raycast gave us the intersection point so sphere radius is already accounted for
 			}
 
 			if (SQType == ERaycastType::Sweep && !bTriangleIntersects)
@@ -29,10 +29,17 @@ T_SCALAR LinearlyInterpolateHelper(const TArrayND<T_SCALAR, 2>& ScalarN, const T
 template<class T_SCALAR, class T>
 T_SCALAR LinearlyInterpolateHelper(const TArrayND<T_SCALAR, 3>& ScalarN, const TVector<int32, 3>& CellPrev, const TVector<T, 3>& Alpha)
 {
-	const T_SCALAR interpx1 = LinearlyInterpolate1D(ScalarN(CellPrev), ScalarN(CellPrev + TVector<int32, 3>(1, 0, 0)), Alpha[0]);
-	const T_SCALAR interpx2 = LinearlyInterpolate1D(ScalarN(CellPrev + TVector<int32, 3>(0, 1, 0)), ScalarN(CellPrev + TVector<int32, 3>(1, 1, 0)), Alpha[0]);
-	const T_SCALAR interpx3 = LinearlyInterpolate1D(ScalarN(CellPrev + TVector<int32, 3>(0, 0, 1)), ScalarN(CellPrev + TVector<int32, 3>(1, 0, 1)), Alpha[0]);
-	const T_SCALAR interpx4 = LinearlyInterpolate1D(ScalarN(CellPrev + TVector<int32, 3>(0, 1, 1)), ScalarN(CellPrev + TVector<int32, 3>(1, 1, 1)), Alpha[0]);
+	// Index the 8 corners from one base offset instead of recomputing the 3D index for each. The strides come from the
+	// array itself, face components have one more entry than the cell counts along their axis.
+	const TVector<int32, 3>& ScalarCounts = ScalarN.Counts();
+	const int32 StrideZ = 1;
+	const int32 StrideY = ScalarCounts[2];
+	const int32 StrideX = ScalarCounts[1] * ScalarCounts[2];
+	const int32 Base = CellPrev[0] * StrideX + CellPrev[1] * StrideY + CellPrev[2];
+	const T_SCALAR interpx1 = LinearlyInterpolate1D(ScalarN[Base], ScalarN[Base + StrideX], Alpha[0]);
+	const T_SCALAR interpx2 = LinearlyInterpolate1D(ScalarN[Base + StrideY], ScalarN[Base + StrideX + StrideY], Alpha[0]);
+	const T_SCALAR interpx3 = LinearlyInterpolate1D(ScalarN[Base + StrideZ], ScalarN[Base + StrideX + StrideZ], Alpha[0]);
+	const T_SCALAR interpx4 = LinearlyInterpolate1D(ScalarN[Base + StrideY + StrideZ], ScalarN[Base + StrideX + StrideY + StrideZ], Alpha[0]);
 	const T_SCALAR interpy1 = LinearlyInterpolate1D(interpx1, interpx2, Alpha[1]);
 	const T_SCALAR interpy2 = LinearlyInterpolate1D(interpx3, interpx4, Alpha[1]);
 	return LinearlyInterpolate1D(interpy1, interpy2, Alpha[2]);
@@ -119,7 +126,7 @@ TVector<T, d> TUniformGridBase<T, d>::LinearlyInterpolate(const TArrayFaceND<T,
 		}
 		else
 		{
-			Result[i] = LinearlyInterpolateComponent(ScalarN.GetComponent(i), X, Index.First);
+			Result[i] = LinearlyInterpolateComponent(ScalarN.GetComponent(i), X, i);
 		}
 	}
 	return Result;